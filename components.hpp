@@ -35,26 +35,29 @@ inline lemlib::ControllerSettings armAngularControllerSmallAngle(2, // proportio
 );
 
 // Other Subsystems
-inline std::unordered_map<std::string, std::shared_ptr<pros::Distance>> distances {
-    {"left", std::make_shared<pros::Distance>(0)},
-    {"right", std::make_shared<pros::Distance>(0)},
-    {"front", std::make_shared<pros::Distance>(0)}};
+inline pros::Distance leftDistance(0); // left distance sensor
+inline pros::Distance rightDistance(0); // right distance sensor
+inline pros::Distance frontDistance(0); // front distance sensor
+// distance sensors and where they are mounted, see constants.hpp
+inline lemlib::DistanceSensorRegistry distances {{lemlib::DistanceSide::LEFT, &leftDistance, LEFT_DISTANCE_MOUNT},
+                                                 {lemlib::DistanceSide::RIGHT, &rightDistance, RIGHT_DISTANCE_MOUNT},
+                                                 {lemlib::DistanceSide::FRONT, &frontDistance, FRONT_DISTANCE_MOUNT}};
 
 inline pros::Optical ColorSensor(3); // color sensor - port 3
 inline ArmNamespace::Arm arm(std::make_shared<pros::Motor>(0, pros::v5::MotorGears::red), // arm - motor port 5 (reversed)
                       std::make_shared<pros::Rotation>(0), // rotation sensor - port 17 (reversed)
                       armAngularController, armAngularControllerSmallAngle); // PID controller
-inline SpinnerNamespace::Spinner intake(std::make_shared<pros::Motor>(13, pros::v5::MotorGears::blue)); // intake - motor port 7
-inline SpinnerNamespace::Spinner hood(std::make_shared<pros::Motor>(-14, pros::v5::MotorGears::blue)); // hooks - motor port 11
+inline SpinnerNamespace::Spinner intake(std::make_shared<pros::Motor>(13, pros::v5::MotorGears::blue), "intake"); // intake - motor port 7
+inline SpinnerNamespace::Spinner hood(std::make_shared<pros::Motor>(-14, pros::v5::MotorGears::blue), "hood"); // hooks - motor port 11
 inline ConveyorNamespace::Conveyor conveyor(&intake, // intake
                                      &hood, // hooks
                                      std::make_shared<pros::Optical>(0) // optical sensor - port 14
                                    // distance sensor - port 20
 );
-inline HolderNamespace::Holder goal_transfer(std::make_shared<pros::adi::DigitalOut>('F')); // mobile goal holder - port 'B'
-inline HolderNamespace::Holder Lipper(std::make_shared<pros::adi::DigitalOut>('A')); // doinker - port 'A'
-inline HolderNamespace::Holder Descore(std::make_shared<pros::adi::DigitalOut>('H')); // hanger - port 'H'
-inline HolderNamespace::Holder deadwheel_lifter(std::make_shared<pros::adi::DigitalOut>('B')); // deadwheel lifter - port 'C'
+inline HolderNamespace::Holder goal_transfer(std::make_shared<pros::adi::DigitalOut>('F'), "goal transfer"); // mobile goal holder - port 'B'
+inline HolderNamespace::Holder Lipper(std::make_shared<pros::adi::DigitalOut>('A'), "lipper"); // doinker - port 'A'
+inline HolderNamespace::Holder Descore(std::make_shared<pros::adi::DigitalOut>('H'), "descore"); // hanger - port 'H'
+inline HolderNamespace::Holder deadwheel_lifter(std::make_shared<pros::adi::DigitalOut>('B'), "deadwheel lifter"); // deadwheel lifter - port 'C'
 
 
 // Inertial Sensor on port 21
@@ -128,17 +131,20 @@ inline lemlib::ExpoDriveCurve steerCurve(3, // joystick deadband out of 127
 inline lemlib::Chassis chassis(drivetrain, linearController, angularController, sensors, &throttleCurve, &steerCurve);
 
 
-// angular motion controller
-inline lemlib::ControllerSettings angularControllerSmall(1.1, // proportional gain (kP)
-                                             0.05, // integral gain (kI)
-                                             0, // derivative gain (kD)
-                                             3, // anti windup
-                                             0.5, // small error range, in degrees
-                                             100, // small error range timeout, in milliseconds
-                                             1, // large error range, in degrees
-                                             500, // large error range timeout, in milliseconds
-                                             0 // maximum acceleration (slew)
+// angular gains for turns and swings, by how far is left to turn and how fast the robot is turning. Small turns need
+// some kI and no kD to finish the last few degrees, but a robot arriving fast from a large turn still needs the kD
+// of angularController to stop
+inline lemlib::GainSchedule angularSchedule({5, 30}, // error, in degrees
+                                            {0, 180}, // angular velocity, in degrees per second
+                                            {{{1.1, 0.05, 0}, {2, 0, 10}}, // 5 degrees: still, turning fast
+                                             {{2, 0, 10}, {2, 0, 10}}} // 30 degrees: still, turning fast
 );
 
-// create the chassis
-inline lemlib::Chassis chassisSmall(drivetrain, linearController, angularControllerSmall, sensors, &throttleCurve, &steerCurve);
\ No newline at end of file
+// profiled turns, for turns with profiled set. Starting points, measure kS, kV and kA by characterizing turning. The
+// drivetrain can turn at about 760 degrees per second, so the max velocity leaves power for the PID to correct with
+inline lemlib::TurnProfileSettings turnProfile(600, // max angular velocity, in degrees per second
+                                               3000, // max angular acceleration, in degrees per second squared
+                                               6, // power to overcome friction (kS)
+                                               0.16, // power per degree per second (kV)
+                                               0.01 // power per degree per second squared (kA)
+);
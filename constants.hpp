@@ -1,8 +1,15 @@
 #pragma once
 
+#include <cmath>
+#include "lemlib/chassis/wallCorrection.hpp"
+
 // Auton Selection
 constexpr bool autonSelector = false;
 
+// Subsystems
+constexpr int DEVICE_REFRESH_TIME = 500; // ms, unchanged motor and solenoid commands are resent this often anyway
+constexpr int TIMING_TELEMETRY_PERIOD = 5000; // ms between task timing reports through the telemetry sink
+
 // Arm
 constexpr float MAX_DEGREES = 23000.0f; // 150 degrees
 constexpr float WAIT_DEGREES = 2500.0f; // 35 degrees
@@ -12,25 +19,38 @@ constexpr float DESCORE_DEGREES = 14500; // 150 degrees
 constexpr float SCORE_DEGREES = 16000;
 constexpr float AUTO_DEGREES = 20500;
 
+// arm controller, angles in degrees and outputs in motor power (-127 to 127). Starting points, tune on the robot
+constexpr float ARM_HORIZONTAL_DEGREES = VERTICAL_DEGREES / 100 - 90; // where gravity pulls on the arm the most
+constexpr float ARM_MAX_VELOCITY = 300; // degrees per second
+constexpr float ARM_MAX_ACCELERATION = 1500; // degrees per second squared
+constexpr float ARM_KG = 12; // power that holds the arm up when it is horizontal
+constexpr float ARM_KS = 4; // power that overcomes friction
+constexpr float ARM_KV = 0.3; // power per degree per second
+constexpr float ARM_KA = 0.02; // power per degree per second squared
+constexpr float ARM_DERIVATIVE_FILTER = 0.03; // time constant of the PID derivative's low pass filter, in seconds
+
 
 // Holder
 constexpr int AUTO_HOLD_TIMEOUT = 1000; // 1 sec
-static bool activeAutoClamp = true;
+inline bool activeAutoClamp = true;
 inline bool withAutoClamp = true;
 
 // Odom
 constexpr int MAX_DIST_INCHES = 48;
-constexpr int MAX_DIST_MM = 1000;
-
-constexpr double BACK_OFFSET_INCHES = 5;
-constexpr double LEFT_OFFSET_INCHES = 5.75;
-constexpr double RIGHT_OFFSET_INCHES = 5.75;
-constexpr double FRONT_OFFSET_INCHES = 5;
 
 constexpr double FEILD_SIZE = 71;
+// record odometry's sensors during auton, to replay offline with make replay
+constexpr bool RECORD_SENSOR_LOG = false;
+constexpr const char* SENSOR_LOG_PATH = "/usd/sensors.csv";
+
+// distance sensor mounts: inches right and forward of the tracking center, facing, max range.
+// static/rangeTable.bin is generated for these, so run `make range-table` after changing them
+constexpr lemlib::DistanceMount LEFT_DISTANCE_MOUNT = {-5.75, 0, -M_PI / 2, MAX_DIST_INCHES};
+constexpr lemlib::DistanceMount RIGHT_DISTANCE_MOUNT = {5.75, 0, M_PI / 2, MAX_DIST_INCHES};
+constexpr lemlib::DistanceMount FRONT_DISTANCE_MOUNT = {0, 5, 0, MAX_DIST_INCHES};
  
 // Conveyor
-inline bool withAntiJam = false;
+inline bool withAntiJam = true; // spinners reverse out of jams on their own during auton
 constexpr double RED_HIGH_THRESHOLD = 340;
 constexpr double BLUE_HIGH_THRESHOLD = 270;
 
@@ -40,14 +60,35 @@ constexpr int PROXIMITY_THRESHOLD = 100;
 constexpr int STUCK_CURRENT = 2000;
 constexpr int STUCK_RPM = 20;
 constexpr double STUCK_TORQUE = 0.7;
+constexpr int JAM_WINDOW = 10; // samples (10ms each) the stuck thresholds are averaged over
+constexpr int JAM_SPINUP_TIME = 250; // ms after a spinner is commanded before it can be considered jammed
+constexpr int JAM_REVERSE_TIME = 150; // ms a jammed spinner reverses for before resuming
+constexpr int JAM_MIN_POWER = 60; // slower states push against rings on purpose, so they are never jammed
+
+// color sort, distances in degrees of hood motor travel. Tune these on the robot
+constexpr double RING_TRAVEL_DEGREES = 540; // from the optical sensor to the top of the hood
+constexpr double RING_PASSED_DEGREES = 90; // past the top a ring has left the hood
+constexpr double EJECT_DEGREES = 120; // how far the hood reverses to throw a ring off
+constexpr int EJECT_TIMEOUT = 250; // ms, stop reversing if the hood can't
+constexpr int RING_DEBOUNCE = 2; // samples a ring has to be seen, or gone, for
 
 constexpr double SPEEDRATIO = 1.0;
 constexpr double DIST_THRESHOLD = 40;
-constexpr int check_interval = 10;
 
 //constexpr bool AUTO_STARTED = true;
 
 //Skills
 constexpr bool RUN_SKILLS = false;
 
+// Characterization. Set RUN_CHARACTERIZATION to run the tests instead of an auton, then fit the log with
+// make characterize. Powers are from -127 to 127
+constexpr bool RUN_CHARACTERIZATION = false;
+constexpr float CHARACTERIZE_RAMP = 12; // power per second of the quasistatic tests, about 1V per second
+constexpr float CHARACTERIZE_STEP = 80; // power of the dynamic tests, about 7.5V
+constexpr float CHARACTERIZE_ARM_STEP = 40; // the arm only has a short range to accelerate in
+constexpr int CHARACTERIZE_TIMEOUT = 10000; // ms, longest a test can take
+constexpr int CHARACTERIZE_REST = 1000; // ms the mechanism is given to stop between tests
+constexpr float CHARACTERIZE_DRIVE_TRAVEL = 72; // inches the drivetrain can move each way
+constexpr float CHARACTERIZE_ARM_TRAVEL = (AUTO_DEGREES - DOWN_DEGREES) / 100 - 10; // degrees, short of the top
+
 
@@ -1,10 +1,19 @@
 #pragma once
 
 #include "lemlib/pid.hpp" // IWYU pragma: keep
+#include "lemlib/gainSchedule.hpp" // IWYU pragma: keep
+#include "lemlib/trapezoidProfile.hpp" // IWYU pragma: keep
+#include "lemlib/characterization.hpp" // IWYU pragma: keep
 #include "lemlib/pose.hpp" // IWYU pragma: keep
 #include "lemlib/util.hpp" // IWYU pragma: keep
+#include "lemlib/taskStats.hpp" // IWYU pragma: keep
+#include "lemlib/periodicTask.hpp" // IWYU pragma: keep
 #include "lemlib/chassis/chassis.hpp"
+#include "lemlib/chassis/odom.hpp" // IWYU pragma: keep
 #include "lemlib/chassis/trackingWheel.hpp" // IWYU pragma: keep
+#include "lemlib/chassis/sensorSnapshot.hpp" // IWYU pragma: keep
+#include "lemlib/chassis/distanceSensors.hpp" // IWYU pragma: keep
+#include "lemlib/chassis/rangeTable.hpp" // IWYU pragma: keep
 #include "lemlib/logger/logger.hpp" // IWYU pragma: keep
 
 // using to shorten lemlib::AngularDirection to just AngularDirection
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace lemlib {
+/**
+ * @brief The tests a mechanism can be characterized with
+ */
+enum class CharacterizationTest {
+    QUASISTATIC, /** ramp the power up slowly, so the mechanism barely accelerates */
+    DYNAMIC /** step the power, so the mechanism accelerates as fast as it can */
+};
+
+/**
+ * @brief One sample of a characterization test
+ */
+struct CharacterizationSample {
+        uint32_t time; // ms since the test started
+        float power; // power the mechanism was given, from -127 to 127
+        float position; // position of the mechanism, in whatever unit it uses
+};
+
+/**
+ * @brief Runs characterization tests on a mechanism, and logs them to be fitted on the computer
+ *
+ * A test gives the mechanism a known power, either ramped up slowly or stepped, and records how it moves. The samples
+ * are kept in memory while the test runs, so logging doesn't slow it down, and sent through the telemetry sink once it
+ * is done, in records of:
+ *   CHAR,name,test,time,power,position[,time,power,position...]
+ * where test is quasistatic-forward, quasistatic-backward, dynamic-forward or dynamic-backward. The records are sent at
+ * Level::INFO, so the telemetry sink lets INFO through while they are sent and then goes back to its lowest level.
+ * `make characterize` builds the tool that fits kS, kV, kA (and kG for a mechanism gravity acts on) to the log, and
+ * suggests PID gains.
+ */
+class Characterization {
+    public:
+        /**
+         * @brief the most samples a test records. Tests stop once they have this many
+         */
+        static constexpr int MAX_SAMPLES = 1000;
+        /**
+         * @brief the period of a test, in ms
+         */
+        static constexpr int PERIOD = 10;
+
+        /**
+         * @brief Create a new Characterization
+         *
+         * @param name name of the mechanism in the log. Can't contain commas
+         * @param setPower gives the mechanism a power, from -127 to 127
+         * @param getPosition returns the position of the mechanism. Positive power should make it increase
+         *
+         * @b Example
+         * @code {.cpp}
+         * lemlib::Characterization turn(
+         *     "turn",
+         *     [](float power) {
+         *         leftMotors.move(power);
+         *         rightMotors.move(-power);
+         *     },
+         *     [] { return chassis.getPose().theta; });
+         * turn.run(lemlib::CharacterizationTest::QUASISTATIC, true, 12, 10000);
+         * @endcode
+         */
+        Characterization(std::string name, std::function<void(float power)> setPower,
+                         std::function<float()> getPosition);
+
+        /**
+         * @brief Run a test, then stop the mechanism and log the samples. This function blocks
+         *
+         * @param test which test to run
+         * @param forwards whether to give the mechanism positive power
+         * @param power how fast the power ramps up in a quasistatic test, in power per second, or the power of the step
+         * in a dynamic test
+         * @param timeout longest the test can take, in ms
+         * @param maxTravel the test stops once the mechanism has moved this far, to keep it inside its range of motion
+         * @return int how many samples were recorded
+         */
+        int run(CharacterizationTest test, bool forwards, float power, int timeout, float maxTravel = INFINITY);
+    private:
+        /**
+         * @brief log the samples of the last test
+         *
+         * @param test name of the test in the log
+         */
+        void log(const std::string& test) const;
+
+        const std::string name;
+        const std::function<void(float)> setPower;
+        const std::function<float()> getPosition;
+        std::vector<CharacterizationSample> samples;
+};
+} // namespace lemlib
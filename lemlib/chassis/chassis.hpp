@@ -5,11 +5,16 @@
 #include "pros/distance.hpp"
 #include "lemlib/asset.hpp"
 #include "lemlib/chassis/trackingWheel.hpp"
+#include "lemlib/chassis/distanceSensors.hpp"
+#include "lemlib/chassis/globalLocalization.hpp"
 #include "lemlib/pose.hpp"
 #include "lemlib/pid.hpp"
+#include "lemlib/gainSchedule.hpp"
+#include "lemlib/trapezoidProfile.hpp"
 #include "lemlib/exitcondition.hpp"
 #include "lemlib/driveCurve.hpp"
 
+#include <optional>
 #include <set>
 
 namespace lemlib {
@@ -29,7 +34,7 @@ class OdomSensors {
          * @param horizontal1 pointer to the first horizontal tracking wheel
          * @param horizontal2 pointer to the second horizontal tracking wheel
          * @param imu pointer to the IMU
-         * @param distances pointer to the distance sensors
+         * @param distances pointer to the distance sensors and their mounts
          *
          * @b Example
          * @code {.cpp}
@@ -47,13 +52,13 @@ class OdomSensors {
          */
         OdomSensors(TrackingWheel* vertical1, TrackingWheel* vertical2, TrackingWheel* horizontal1,
                     TrackingWheel* horizontal2, pros::Imu* imu,
-                    std::unordered_map<std::string, std::shared_ptr<pros::Distance>>* distances);
+                    DistanceSensorRegistry* distances);
         TrackingWheel* vertical1;
         TrackingWheel* vertical2;
         TrackingWheel* horizontal1;
         TrackingWheel* horizontal2;
         pros::Imu* imu;
-        std::unordered_map<std::string, std::shared_ptr<pros::Distance>>* distances;
+        DistanceSensorRegistry* distances;
 };
 
 /**
@@ -117,6 +122,52 @@ class ControllerSettings {
         float slew;
 };
 
+/**
+ * @brief class containing constants for profiled turns
+ */
+class TurnProfileSettings {
+    public:
+        /**
+         * @brief TurnProfileSettings constructor
+         *
+         * A profiled turn follows a trapezoidal angular velocity profile, accelerating as hard as the robot can,
+         * turning as fast as it can, and decelerating in time to stop at the target. The feedforward gives the power
+         * the robot needs to follow the profile, and the angular PID corrects what it misses, then finishes the turn.
+         *
+         * Characterize turning with lemlib::Characterization and make characterize to measure the gains. At full power
+         * the robot turns at up to (127 - kS) / kV and accelerates from rest at up to (127 - kS) / kA. Keep the max
+         * velocity and acceleration below that, so there is power left for the PID to correct with
+         *
+         * @param maxVelocity max angular velocity, in degrees per second
+         * @param maxAcceleration max angular acceleration, in degrees per second squared
+         * @param kS power to overcome friction
+         * @param kV power per degree per second
+         * @param kA power per degree per second squared
+         *
+         * @b Example
+         * @code {.cpp}
+         * lemlib::TurnProfileSettings turnProfile(600, // max angular velocity, in degrees per second
+         *                                         3000, // max angular acceleration, in degrees per second squared
+         *                                         6, // kS
+         *                                         0.15, // kV
+         *                                         0.01); // kA
+         * chassis.setTurnProfile(turnProfile);
+         * @endcode
+         */
+        TurnProfileSettings(float maxVelocity, float maxAcceleration, float kS, float kV, float kA)
+            : maxVelocity(maxVelocity),
+              maxAcceleration(maxAcceleration),
+              kS(kS),
+              kV(kV),
+              kA(kA) {}
+
+        float maxVelocity;
+        float maxAcceleration;
+        float kS;
+        float kV;
+        float kA;
+};
+
 /**
  * @brief class containing constants for a drivetrain
  */
@@ -203,6 +254,8 @@ struct TurnToPointParams {
         /** angle between the robot and target point where the movement will exit. Only has an effect if minSpeed is
          * non-zero.*/
         float earlyExitRange = 0;
+        /** whether to follow a time optimal velocity profile, see Chassis::setTurnProfile. False by default */
+        bool profiled = false;
 };
 
 /**
@@ -224,6 +277,8 @@ struct TurnToHeadingParams {
         /** angle between the robot and target point where the movement will exit. Only has an effect if minSpeed is
          * non-zero.*/
         float earlyExitRange = 0;
+        /** whether to follow a time optimal velocity profile, see Chassis::setTurnProfile. False by default */
+        bool profiled = false;
 };
 
 /**
@@ -339,7 +394,17 @@ extern ExpoDriveCurve defaultDriveCurve;
 class Chassis {
     public:
 
+        /**
+         * @brief Get the forward velocity of the robot from the latest sensor snapshot
+         *
+         * @return double velocity in inches per second
+         */
         double getForwardVelocity();
+        /**
+         * @brief Get the yaw rate of the robot from the latest sensor snapshot
+         *
+         * @return double yaw rate in radians per second, positive clockwise
+         */
         double getYawRate();
         /**
          * @brief Chassis constructor
@@ -407,6 +472,25 @@ class Chassis {
          */
         void correctByDistanceSensors();
 
+        /**
+         * @brief Find the chassis anywhere on the field with the distance sensors, and set the pose to it
+         *
+         * The chassis must be still. This catches the robot being placed on the wrong tile, but the heading of the
+         * hint must be within 45 degrees of the real heading. See lemlib::localize()
+         *
+         * @param hint where the chassis should be
+         * @param radians whether hint theta is in radians (true) or not (false). false by default
+         * @return GlobalLocalization the pose found. The pose isn't changed if found is false
+         *
+         * @b Example
+         * @code {.cpp}
+         * // the robot should be at (-60, -36) facing 90 degrees, but may be on the wrong tile
+         * lemlib::GlobalLocalization result = chassis.localize({-60, -36, 90});
+         * if (!result.found) chassis.setPose(-60, -36, 90);
+         * @endcode
+         */
+        GlobalLocalization localize(Pose hint, bool radians = false);
+
         /**
          * @brief Set the pose of the chassis
          *
@@ -503,6 +587,39 @@ class Chassis {
          * @endcode
          */
         void setBrakeMode(pros::motor_brake_mode_e mode);
+        /**
+         * @brief Schedule the angular gains of turns and swings on the error and the angular velocity
+         *
+         * Every iteration of turnToHeading, turnToPoint, swingToHeading and swingToPoint sets the angular PID's gains
+         * from the schedule, using the error in degrees and the angular velocity in degrees per second. The gains in
+         * the angular ControllerSettings are used for every other motion, and for turns without a schedule
+         *
+         * @param schedule the schedule, which has to outlive the chassis. nullptr to stop scheduling
+         * @return true if the schedule is used, false if it isn't valid
+         *
+         * @b Example
+         * @code {.cpp}
+         * // gentle gains with some kI to finish small turns, unless the robot is arriving fast from a large one
+         * lemlib::GainSchedule schedule({5, 30}, {0, 180}, {{{1.1, 0.05, 0}, {2, 0, 10}}, {{2, 0, 10}, {2, 0, 10}}});
+         * chassis.setAngularGainSchedule(&schedule);
+         * @endcode
+         */
+        bool setAngularGainSchedule(const GainSchedule* schedule);
+        /**
+         * @brief Set the profile turnToHeading and turnToPoint follow when their params have profiled set
+         *
+         * The angular PID follows the profile and then finishes the turn, with the gain schedule if there is one
+         *
+         * @param settings the max velocity, max acceleration and feedforward of turning
+         *
+         * @b Example
+         * @code {.cpp}
+         * chassis.setTurnProfile(lemlib::TurnProfileSettings(600, 3000, 6, 0.15, 0.01));
+         * // turn to face heading 90 as fast as the robot can
+         * chassis.turnToHeading(90, 1000, {.profiled = true});
+         * @endcode
+         */
+        void setTurnProfile(TurnProfileSettings settings);
         /**
          * @brief Turn the chassis so it is facing the target point
          *
@@ -971,6 +1088,34 @@ class Chassis {
          * @brief Dequeues this motion and permits queued task to run
          */
         void endMotion();
+        /**
+         * @brief Set the angular PID's gains from the angular gain schedule, if there is one
+         *
+         * @param error angular error, in degrees
+         */
+        void scheduleAngularGains(float error);
+        /**
+         * @brief Set the angular PID's gains back to the ones in the angular ControllerSettings
+         */
+        void resetAngularGains();
+        /**
+         * @brief Start a profiled turn, if the params asked for one and a profile is set
+         *
+         * @param profile set to the profile of the angular error, from the error at the start to 0
+         * @param deltaTheta angular error at the start of the turn, in degrees
+         * @param maxSpeed the turn's max speed, out of 127. The max velocity is scaled down to match
+         * @return true if the turn is profiled
+         */
+        bool startTurnProfile(TrapezoidProfile& profile, float deltaTheta, float maxSpeed);
+        /**
+         * @brief Get the power that follows the turn profile for one iteration
+         *
+         * @param profile the profile of the angular error
+         * @param deltaTheta angular error, in degrees
+         * @param dt time since the last iteration, in seconds
+         * @return float power, positive clockwise
+         */
+        float followTurnProfile(TrapezoidProfile& profile, float deltaTheta, float dt);
 
         bool motionRunning = false;
         bool motionQueued = false;
@@ -979,6 +1124,8 @@ class Chassis {
 
         ControllerSettings lateralSettings;
         ControllerSettings angularSettings;
+        const GainSchedule* angularSchedule = nullptr;
+        std::optional<TurnProfileSettings> turnProfile;
         Drivetrain drivetrain;
         OdomSensors sensors;
         DriveCurve* throttleCurve;
@@ -990,9 +1137,5 @@ class Chassis {
         ExitCondition angularSmallExit;
     private:
         pros::Mutex mutex;
-        double prev_left = 0;
-        double prev_right = 0;
-        double prev_yaw = 0;
-        double prev_time = 0;
 };
 } // namespace lemlib
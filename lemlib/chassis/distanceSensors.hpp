@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <initializer_list>
+#include "pros/distance.hpp"
+#include "lemlib/chassis/sensorSnapshot.hpp"
+#include "lemlib/chassis/wallCorrection.hpp"
+
+namespace lemlib {
+/**
+ * @brief The distance sensors used for odometry, and where they are mounted
+ *
+ * Sensors are stored in an array indexed by DistanceSide, so odometry, the particle filter and wall corrections can
+ * find them without looking anything up by name.
+ */
+class DistanceSensorRegistry {
+    public:
+        /**
+         * @brief A distance sensor and its mount
+         */
+        struct Entry {
+                /** the slot the sensor goes in */
+                DistanceSide side;
+                /** the sensor. Must outlive the registry */
+                pros::Distance* sensor;
+                /** where the sensor is mounted */
+                DistanceMount mount;
+        };
+
+        /**
+         * @brief Create a new DistanceSensorRegistry
+         *
+         * @param entries the sensors and their mounts. Slots without a sensor are unused
+         *
+         * @b Example
+         * @code {.cpp}
+         * pros::Distance frontDistance(1);
+         * pros::Distance leftDistance(2);
+         * lemlib::DistanceSensorRegistry distances {
+         *     // 5 inches in front of the tracking center, facing forwards, up to 48 inches
+         *     {lemlib::DistanceSide::FRONT, &frontDistance, {0, 5, 0, 48}},
+         *     // 5.75 inches left of the tracking center and 2 inches back, facing left
+         *     {lemlib::DistanceSide::LEFT, &leftDistance, {-5.75, -2, -M_PI / 2, 48}},
+         * };
+         * @endcode
+         */
+        DistanceSensorRegistry(std::initializer_list<Entry> entries);
+        /**
+         * @brief Get the sensor in a slot
+         *
+         * @param side the slot
+         * @return pros::Distance* the sensor, or nullptr if the slot is unused
+         */
+        pros::Distance* getSensor(DistanceSide side) const;
+        /**
+         * @brief Get the mount of the sensor in a slot
+         *
+         * @param side the slot
+         * @return const DistanceMount&
+         */
+        const DistanceMount& getMount(DistanceSide side) const;
+        /**
+         * @brief Get the mounts of every slot, indexed by DistanceSide
+         *
+         * @return const std::array<DistanceMount, DISTANCE_SIDES>&
+         */
+        const std::array<DistanceMount, DISTANCE_SIDES>& getMounts() const;
+    private:
+        std::array<pros::Distance*, DISTANCE_SIDES> sensors {};
+        std::array<DistanceMount, DISTANCE_SIDES> mounts {};
+};
+} // namespace lemlib
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include "lemlib/pose.hpp"
+#include "lemlib/chassis/sensorSnapshot.hpp"
+#include "lemlib/chassis/wallCorrection.hpp"
+
+namespace lemlib {
+/**
+ * @brief Settings for finding the robot anywhere on the field
+ */
+struct GlobalLocalizationSettings {
+        /** distance from the center of the field to each wall, in inches */
+        float fieldHalfSize = 71;
+        /** readings with a lower confidence are ignored, from 0 to 63 */
+        int32_t minConfidence = 40;
+        /**
+         * how far from the heading of the hint to search, in radians. The walls look the same every quarter turn, so
+         * M_PI / 4 covers every heading, and the hint only picks which of the four matching poses is right
+         */
+        float headingWindow = M_PI / 4;
+        /**
+         * standard deviation of the real heading around the heading of the hint, in radians. The robot is usually
+         * placed by hand, so its heading is known much better than its tile. INFINITY searches every heading equally
+         */
+        float headingNoise = 0.1;
+        /** distance between the poses tried by the coarse search, in inches */
+        float coarseStep = 3;
+        /** angle between the headings tried by the coarse search, in radians */
+        float coarseHeadingStep = 0.05;
+        /** the refinement stops once its step is shorter than this, in inches */
+        float fineStep = 0.05;
+        /** how many of the best coarse poses are refined */
+        int candidates = 8;
+        /** closest the tracking center can be to a wall, in inches */
+        float wallClearance = 6;
+        /** differences between a reading and the expected distance are capped at this many standard deviations */
+        float outlier = 3;
+};
+
+/**
+ * @brief The pose found by a global localization
+ */
+struct GlobalLocalization {
+        /** whether enough readings were usable to find a pose */
+        bool found = false;
+        /** the pose that best explains the readings, with theta in radians */
+        Pose pose = {0, 0, 0};
+        /** rms difference between the readings and the distances expected at pose, in standard deviations */
+        float error = 0;
+        /**
+         * the best pose that is clearly different from pose (3 inches or 0.1 radians away), and how much worse it
+         * explains the readings. A small gap means the readings fit several places equally well, e.g. when only one
+         * wall is in range. It is negative if the alternative fits a little better but is further from the hint.
+         * Infinite if every candidate ended up at the same pose
+         */
+        Pose alternative = {0, 0, 0};
+        float gap = 0;
+        /** number of readings used */
+        int used = 0;
+        /** number of poses scored */
+        int evaluated = 0;
+        /** time taken, in microseconds */
+        uint32_t time = 0;
+};
+
+/**
+ * @brief Get the median reading of each distance sensor over several snapshots
+ *
+ * A sensor that had a valid reading in fewer than half the snapshots is marked invalid, since it only sometimes sees
+ * something.
+ *
+ * @param snapshots the snapshots
+ * @param count number of snapshots
+ * @return std::array<DistanceReading, DISTANCE_SIDES> indexed by DistanceSide
+ */
+std::array<DistanceReading, DISTANCE_SIDES> medianDistances(const SensorSnapshot* snapshots, int count);
+
+/**
+ * @brief Find the pose of the robot on the field from distance sensor readings alone
+ *
+ * Meant to be run while the robot is still, e.g. before the match, to catch the robot being placed on the wrong tile.
+ * Every pose on a coarse grid over the field, at headings near the hint, is scored by how well the distances expected
+ * to the walls match the readings, and how close its heading is to the hint's. The expected distances are calculated
+ * from a table of where each sensor is and which way it points at each heading, built once per call, so scoring a
+ * pose is a few multiplications per sensor. The best poses are then refined with a pattern search. Readings longer
+ * than the sensor's range count as seeing no wall, which rules out poses where a wall should be in range.
+ *
+ * @param readings the distance sensor readings. Averaging a few readings first reduces the noise
+ * @param mounts where each sensor is mounted. Indexed the same as readings
+ * @param count number of readings
+ * @param hint roughly where the robot should be, with theta in radians. Its heading only needs to be within
+ * headingWindow. Its position only breaks ties between poses that explain the readings about as well as each other
+ * @param settings the global localization settings
+ * @return GlobalLocalization
+ */
+GlobalLocalization localizeGlobally(const DistanceReading* readings, const DistanceMount* mounts, int count,
+                                    const Pose& hint, const GlobalLocalizationSettings& settings);
+} // namespace lemlib
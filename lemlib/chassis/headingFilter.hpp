@@ -0,0 +1,94 @@
+#pragma once
+
+namespace lemlib {
+/**
+ * @brief Noise models used by the HeadingFilter
+ *
+ * All angles are in radians. The defaults are reasonable for a V5 inertial sensor and rotation sensor tracking
+ * wheels, and you usually won't need to change them.
+ */
+struct HeadingFilterSettings {
+        /** random walk of the IMU rotation, in radians per sqrt(second) */
+        float imuNoise = 0.002;
+        /** how fast the IMU drift can change, in radians per second per sqrt(second) */
+        float imuBiasNoise = 0.0005;
+        /** initial uncertainty of the IMU drift, in radians per second */
+        float imuBiasInitial = 0.01;
+        /** noise of the tracking wheel heading every update, in radians */
+        float trackingWheelNoise = 0.0005;
+        /** error of the tracking wheel heading as a fraction of how far the robot turned, from scrub */
+        float trackingWheelScrub = 0.02;
+        /** error of the drivetrain heading as a fraction of how far the robot turned, from wheel slip */
+        float drivetrainScrub = 0.15;
+};
+
+/**
+ * @brief Fuses the IMU and the tracking wheels into one heading
+ *
+ * This is a small Kalman filter that estimates the heading and the drift (bias) of the IMU. Every update the IMU
+ * change in rotation, corrected for the estimated drift, predicts the new heading. The change in heading measured by a
+ * pair of tracking wheels then corrects it. How much each source is trusted depends on its noise model, so the
+ * tracking wheels win while the robot is still or driving straight, and the IMU wins while the robot is turning
+ * quickly and the wheels scrub. Because the IMU drift is estimated while the robot is still or driving straight, it
+ * is removed from the heading during turns too.
+ *
+ * If only one source is available, its change in heading is used directly.
+ */
+class HeadingFilter {
+    public:
+        /**
+         * @brief Create a new HeadingFilter
+         *
+         * @param settings the noise models to use
+         *
+         * @b Example
+         * @code {.cpp}
+         * lemlib::HeadingFilter filter;
+         * // each update, pass the change in IMU rotation and the change in tracking wheel heading
+         * float deltaHeading = filter.update(0.01, true, deltaImu, true, deltaWheels, false);
+         * @endcode
+         */
+        HeadingFilter(HeadingFilterSettings settings = {});
+        /**
+         * @brief Update the filter
+         *
+         * @param dt time since the last update, in seconds
+         * @param hasImu whether the IMU gave a reading this update
+         * @param deltaImu change in IMU rotation since the last update, in radians
+         * @param hasWheels whether a pair of tracking wheels gave a reading this update
+         * @param deltaWheels change in heading measured by the tracking wheels since the last update, in radians
+         * @param driven whether the tracking wheels are the drivetrain wheels, which slip more
+         * @return float the fused change in heading since the last update, in radians
+         */
+        float update(float dt, bool hasImu, float deltaImu, bool hasWheels, float deltaWheels, bool driven);
+        /**
+         * @brief Get the estimated drift of the IMU
+         *
+         * @return float drift in radians per second
+         */
+        float getImuBias() const;
+        /**
+         * @brief Get the uncertainty of the fused heading, accumulated since the last reset
+         *
+         * @return float standard deviation in radians
+         */
+        float getUncertainty() const;
+        /**
+         * @brief Change the noise models. Resets the filter
+         *
+         * @param settings the new noise models
+         */
+        void setSettings(HeadingFilterSettings settings);
+        /**
+         * @brief Forget the estimated IMU drift and the uncertainty of the heading
+         */
+        void reset();
+    private:
+        HeadingFilterSettings settings;
+        float bias = 0;
+        // variance of the IMU drift estimate
+        float pBias = 0;
+        // variance of the heading accumulated since the last reset
+        float variance = 0;
+};
+} // namespace lemlib
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <array>
+#include <random>
+#include <vector>
+#include "particle_filter.h"
+#include "lemlib/pose.hpp"
+#include "lemlib/chassis/rangeTable.hpp"
+#include "lemlib/chassis/sensorSnapshot.hpp"
+#include "lemlib/chassis/wallCorrection.hpp"
+
+namespace lemlib {
+/**
+ * @brief Particle filter tuning
+ *
+ * Noise is given as standard deviations [x [inches], y [inches], theta [rad]]. Use the sweep tool in tools/sweep to
+ * find the cheapest settings that still meet an accuracy target on recorded logs.
+ */
+struct ParticleFilterSettings {
+        /** number of particles */
+        int particles = 729;
+        /** spread of the particles around the pose they are seeded at */
+        std::array<double, 3> initialNoise = {1, 1, 0.01};
+        /** noise added to each particle every prediction step */
+        std::array<double, 3> motionNoise = {1, 1, 0.01};
+        /** landmark measurement noise [x [inches], y [inches]] */
+        std::array<double, 2> landmarkNoise = {1, 1};
+        /** maximum range of the distance sensors, in inches */
+        double sensorRange = 48;
+        /** how quickly the long term average of the measurement likelihood follows it, in (0, 1] */
+        double slowAverageRate = 0.001;
+        /** how quickly the short term average of the measurement likelihood follows it, in (0, 1] */
+        double fastAverageRate = 0.1;
+        /** the short term average has to drop below this fraction of the long term one before particles are replaced */
+        double injectionThreshold = 0.5;
+        /**
+         * most particles replaced with random ones each step when the short term average drops below the long term
+         * one, as a fraction of the particles. This lets the filter find the robot again after it is pushed, at a
+         * bounded cost. 0 turns it off
+         */
+        double maxInjection = 0.2;
+        /**
+         * with a range table, readings further than this many standard deviations from the distance expected from a
+         * particle are taken to have hit something other than a wall, e.g. another robot, and count the same however
+         * far off they are
+         */
+        double rangeOutlier = 3;
+};
+
+/**
+ * @brief Set the particle filter tuning used by odometry
+ *
+ * @note the number of particles and the initial noise take effect the next time the filter is seeded, by
+ * Chassis::setPose
+ *
+ * @param settings the settings
+ */
+void setParticleFilterSettings(const ParticleFilterSettings& settings);
+
+/**
+ * @brief Get the particle filter tuning used by odometry
+ *
+ * @return const ParticleFilterSettings&
+ */
+const ParticleFilterSettings& getParticleFilterSettings();
+
+/**
+ * @brief Get the map of the field used by the particle filter
+ *
+ * @return const Map& the field walls and obstacles
+ */
+const Map& getFieldMap();
+
+/**
+ * @brief Turn distance sensor readings into particle filter landmark observations
+ *
+ * Each valid reading is projected along the beam of its sensor, in the robot frame
+ *
+ * @param snapshot the sensor readings
+ * @param mounts where each distance sensor is mounted, indexed by DistanceSide
+ * @param localDelta motion of the robot during the last update, in the robot frame
+ * @param settings the particle filter settings, for the measurement noise
+ * @param gen random number generator used for the observation noise
+ * @return std::vector<LandmarkObs>
+ */
+std::vector<LandmarkObs> buildObservations(const SensorSnapshot& snapshot, const DistanceMount* mounts,
+                                           const Pose& localDelta, const ParticleFilterSettings& settings,
+                                           std::default_random_engine& gen);
+
+/**
+ * @brief Seed a particle filter around a pose
+ *
+ * @param pf the particle filter
+ * @param settings the particle count and initial noise to use
+ * @param pose the pose, with theta in radians
+ * @param gen random number generator used to jitter the pose
+ */
+void seedParticleFilter(ParticleFilter& pf, const ParticleFilterSettings& settings, const Pose& pose,
+                        std::default_random_engine& gen);
+
+/**
+ * @brief Run one predict, weigh and resample step of a particle filter
+ *
+ * If the observations fit the particles much worse than they used to, some particles are replaced with random ones
+ * (augmented MCL). ParticleFilter::injected and ParticleFilter::injection_time report how many, and the cost.
+ *
+ * @param pf the particle filter
+ * @param settings the noise and sensor range to use
+ * @param dt time since the last step, in seconds
+ * @param localSpeed speed of the robot in the robot frame, in inches and radians per second
+ * @param observations landmark observations from buildObservations
+ * @param map the map of the field
+ */
+void stepParticleFilter(ParticleFilter& pf, const ParticleFilterSettings& settings, double dt, const Pose& localSpeed,
+                        const std::vector<LandmarkObs>& observations, const Map& map);
+
+/**
+ * @brief Run one predict, weigh and resample step of a particle filter, weighing the particles with a beam model
+ *
+ * Each particle is weighed by how well every distance sensor reading matches the distance the sensor should read
+ * from the particle, which is looked up in a range table rather than calculated. Readings past the sensor's range,
+ * and sensors that aren't in the table, are ignored.
+ *
+ * @param pf the particle filter
+ * @param settings the noise to use
+ * @param dt time since the last step, in seconds
+ * @param localSpeed speed of the robot in the robot frame, in inches and radians per second
+ * @param snapshot the sensor readings
+ * @param table the distance each sensor should read at each pose, generated for the robot's mounts
+ * @param map the map of the field
+ */
+void stepParticleFilter(ParticleFilter& pf, const ParticleFilterSettings& settings, double dt, const Pose& localSpeed,
+                        const SensorSnapshot& snapshot, const RangeTable& table, const Map& map);
+
+/**
+ * @brief Get the weighted mean pose of the particles
+ *
+ * The heading is the circular mean of the particles' headings. If the fallback's heading is a number, the mean is
+ * given within half a turn of it, so it follows the same unwrapped heading as odometry
+ *
+ * @param pf the particle filter
+ * @param fallback returned if the weights sum to 0
+ * @return Pose with theta in radians
+ */
+Pose getParticleMean(const ParticleFilter& pf, const Pose& fallback);
+} // namespace lemlib
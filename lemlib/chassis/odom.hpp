@@ -1,6 +1,11 @@
 #pragma once
 
 #include "lemlib/chassis/chassis.hpp"
+#include "lemlib/chassis/globalLocalization.hpp"
+#include "lemlib/chassis/headingFilter.hpp"
+#include "lemlib/chassis/odomIntegrator.hpp"
+#include "lemlib/chassis/rangeTable.hpp"
+#include "lemlib/chassis/wallCorrection.hpp"
 #include "lemlib/pose.hpp"
 #include "pros/distance.hpp"
 
@@ -12,6 +17,25 @@ namespace lemlib {
  * @param drivetrain drivetrain to be used
  */
 void setSensors(lemlib::OdomSensors sensors, lemlib::Drivetrain drivetrain);
+/**
+ * @brief Set the noise models used to fuse the IMU and tracking wheel headings
+ *
+ * @param settings the noise models to use
+ *
+ * @b Example
+ * @code {.cpp}
+ * lemlib::HeadingFilterSettings settings;
+ * settings.trackingWheelScrub = 0.05; // these tracking wheels scrub more than usual
+ * lemlib::setHeadingFilterSettings(settings);
+ * @endcode
+ */
+void setHeadingFilterSettings(lemlib::HeadingFilterSettings settings);
+/**
+ * @brief Get the drift of the IMU estimated by odometry
+ *
+ * @return float drift in radians per second
+ */
+float getImuBias();
 /**
  * @brief Get the pose of the robot
  *
@@ -57,18 +81,144 @@ float getDistanceTraveled();
 /**
  * @brief Update the pose of the robot
  *
+ * @param dt time since the last update, in seconds. 0.01 by default. Only used if the sensor snapshot doesn't have a
+ * measured time between samples
+ */
+void update(float dt = 0.01);
+/**
+ * @brief Set how often odometry updates
+ *
+ * Tracking wheel rotation sensors and the IMU are set to report at the same rate, so a faster rate means smaller
+ * integration steps and lower latency. The particle filter still runs at 100Hz at most.
+ *
+ * @note this must be called before init() (or Chassis::calibrate()) to have any effect
+ *
+ * @param period time between updates in milliseconds, 10 by default. Minimum 5
+ *
+ * @b Example
+ * @code {.cpp}
+ * void initialize() {
+ *     // update odometry every 5ms
+ *     lemlib::setOdomPeriod(5);
+ *     chassis.calibrate();
+ * }
+ * @endcode
  */
-void update();
+void setOdomPeriod(uint32_t period);
+/**
+ * @brief Set how odometry integrates the motion of the robot between updates
+ *
+ * @param integration the integration method. OdomIntegration::ARC by default
+ */
+void setOdomIntegration(OdomIntegration integration);
+/**
+ * @brief Start recording every odometry sensor snapshot to a file
+ *
+ * The file can be replayed offline with the replay and sweep tools. See SensorLog for the format
+ *
+ * @param path the file, usually on the SD card
+ * @return true if recording started
+ *
+ * @b Example
+ * @code {.cpp}
+ * void autonomous() {
+ *     lemlib::startSensorLog("/usd/sensors.csv");
+ *     // run the route, then stop recording once it is done
+ *     lemlib::stopSensorLog();
+ * }
+ * @endcode
+ */
+bool startSensorLog(const char* path);
+/**
+ * @brief Stop recording sensor snapshots, and close the file
+ */
+void stopSensorLog();
 /**
  * @brief Initialize the odometry system
  *
+ * Starts a fixed rate task that calls update() every period (10ms by default, see setOdomPeriod()) with the measured
+ * time between sensor samples
  */
 void init();
 
 /**
- * @brief Correct the odometry using sensors
+ * @brief Correct the position of the robot using the distance sensors and the field walls
+ *
+ * Uses the latest sensor snapshot, so it doesn't read any sensors and is cheap enough to call every update.
+ * Works at any heading. See computeWallCorrection() for how readings are chosen
+ *
+ * @param gain how far to move towards the corrected position, from 0 to 1. 1 by default
+ * @param mask bit i is set if the sensor at DistanceSide i may be used. All sensors by default
+ * @return WallCorrection the corrected position, before the gain is applied
+ *
+ * @b Example
+ * @code {.cpp}
+ * // move a tenth of the way towards the position measured by the distance sensors
+ * lemlib::correctFromWalls(0.1);
+ * // only use the front sensor
+ * lemlib::correctFromWalls(1, 1 << int(lemlib::DistanceSide::FRONT));
+ * @endcode
+ */
+WallCorrection correctFromWalls(float gain = 1, uint32_t mask = UINT32_MAX);
+/**
+ * @brief Set the settings used for wall corrections
+ *
+ * @param settings the wall correction settings
+ */
+void setWallCorrectionSettings(WallCorrectionSettings settings);
+/**
+ * @brief Correct the odometry using every distance sensor, whatever their confidence or the current pose
  */
 void correctByDistanceSensors();
+/**
+ * @brief Find the robot anywhere on the field with the distance sensors, and start odometry and the particle filter
+ * there
+ *
+ * The robot must be still, e.g. before the match. The median of a few sensor snapshots is used, one per odometry
+ * update, and then every pose on the field is searched. See localizeGlobally() for how
+ *
+ * @param hint where the robot should be. Its heading must be within 45 degrees of the real heading
+ * @param radians whether hint theta is in radians (true) or not (false). false by default
+ * @param samples number of sensor snapshots to use. 5 by default
+ * @return GlobalLocalization the pose found, with theta in radians. The pose isn't changed if found is false
+ *
+ * @b Example
+ * @code {.cpp}
+ * // the robot should be at (-60, -36) facing 90 degrees
+ * lemlib::GlobalLocalization result = lemlib::localize({-60, -36, 90});
+ * if (result.found && result.gap < 4) std::cout << "the robot could be in more than one place" << std::endl;
+ * @endcode
+ */
+GlobalLocalization localize(Pose hint, bool radians = false, int samples = 5);
+/**
+ * @brief Set the settings used by localize()
+ *
+ * @param settings the global localization settings
+ */
+void setGlobalLocalizationSettings(GlobalLocalizationSettings settings);
+/**
+ * @brief Weigh the particle filter with a beam model of the distance sensors, using a range table
+ *
+ * The table has to be made for the distance sensors passed to setSensors(), since it is only right for the mounts it
+ * was generated for. Otherwise it isn't used, and the particle filter keeps using landmark observations.
+ *
+ * @param table the table, which must outlive odometry. nullptr to go back to landmark observations
+ * @return true if the table is used
+ *
+ * @b Example
+ * @code {.cpp}
+ * ASSET(rangeTable_bin);
+ * lemlib::RangeTable rangeTable;
+ *
+ * void initialize() {
+ *     chassis.calibrate();
+ *     if (!rangeTable.load(rangeTable_bin) || !lemlib::setRangeTable(&rangeTable)) {
+ *         std::cout << "the range table is out of date, run make range-table" << std::endl;
+ *     }
+ * }
+ * @endcode
+ */
+bool setRangeTable(const RangeTable* table);
 
 /**
  * @brief best pose
@@ -80,6 +230,17 @@ lemlib::Pose bestPoe();
  */
 lemlib::Pose estimatePose();
 
+/**
+ * @brief Correct the position using the named distance sensors, whatever the current pose
+ *
+ * Every reading with a confidence above 40 is used, like before. The mount's maxRange and the wall correction
+ * settings' gate and maxIncidence don't apply
+ *
+ * @note the correctAt functions used to assume the robot was facing exactly 0, 90, 180 or 270 degrees. They now work
+ * at any heading and are all the same. Use correctFromWalls() in new code
+ *
+ * @param sensors names of the sensors to use ("front", "back", "left", "right")
+ */
 void correctAt0(std::set<std::string> sensors);
 void correctAt90(std::set<std::string> sensors);
 void correctAt180(std::set<std::string> sensors);
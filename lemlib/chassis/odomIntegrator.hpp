@@ -0,0 +1,134 @@
+#pragma once
+
+#include "lemlib/pose.hpp"
+#include "lemlib/chassis/sensorSnapshot.hpp"
+#include "lemlib/chassis/headingFilter.hpp"
+
+namespace lemlib {
+/**
+ * @brief How odometry integrates the motion of the robot between updates
+ */
+enum class OdomIntegration {
+    ARC, /** assume the robot moved along an arc of constant curvature. Exact for constant curvature */
+    MIDPOINT /** assume the robot moved in a straight line along its average heading. Second order accurate */
+};
+
+/**
+ * @brief A tracking wheel, as far as the odometry maths is concerned
+ */
+struct OdomWheel {
+        /** whether the wheel exists */
+        bool present = false;
+        /** distance from the tracking center, in inches */
+        float offset = 0;
+        /** whether the wheel is a drivetrain wheel rather than an unpowered tracking wheel */
+        bool driven = false;
+};
+
+/**
+ * @brief The tracking wheels used by odometry, indexed the same as the sensor snapshot
+ */
+struct OdomGeometry {
+        OdomWheel vertical1;
+        OdomWheel vertical2;
+        OdomWheel horizontal1;
+        OdomWheel horizontal2;
+};
+
+/**
+ * @brief Integrates sensor snapshots into a pose
+ *
+ * This is the maths behind update(), without any devices or tasks, so it can also run on a computer to replay
+ * recorded sensor logs.
+ */
+class OdomIntegrator {
+    public:
+        /**
+         * @brief Create a new OdomIntegrator
+         *
+         * @param geometry the tracking wheels to use
+         * @param integration how local motion is integrated
+         *
+         * @b Example
+         * @code {.cpp}
+         * lemlib::OdomGeometry geometry;
+         * geometry.vertical1 = {true, -0.7, false}; // unpowered, 0.7 inches left of the tracking center
+         * geometry.horizontal1 = {true, -2.6, false}; // unpowered, 2.6 inches behind the tracking center
+         * lemlib::OdomIntegrator integrator(geometry);
+         * integrator.update(snapshot, 0.01);
+         * @endcode
+         */
+        OdomIntegrator(OdomGeometry geometry = {}, OdomIntegration integration = OdomIntegration::ARC);
+        /**
+         * @brief Integrate one sensor snapshot
+         *
+         * @param snapshot the sensor readings
+         * @param dt time since the previous snapshot, in seconds
+         */
+        void update(const SensorSnapshot& snapshot, float dt);
+        /**
+         * @brief Get the pose
+         *
+         * @return Pose with theta in radians
+         */
+        Pose getPose() const;
+        /**
+         * @brief Set the pose
+         *
+         * @param pose the new pose, with theta in radians
+         */
+        void setPose(Pose pose);
+        /**
+         * @brief Get the speed, in the field frame
+         *
+         * @return Pose in inches per second and radians per second
+         */
+        Pose getSpeed() const;
+        /**
+         * @brief Get the speed, in the robot frame
+         *
+         * @return Pose in inches per second and radians per second
+         */
+        Pose getLocalSpeed() const;
+        /**
+         * @brief Get the motion during the last update, in the robot frame
+         *
+         * @return Pose in inches and radians
+         */
+        Pose getLocalDelta() const;
+        /**
+         * @brief Get the total distance traveled
+         *
+         * @return float distance in inches
+         */
+        float getDistanceTraveled() const;
+        /**
+         * @brief Change the tracking wheels. Forgets the previous readings
+         *
+         * @param geometry the tracking wheels to use
+         */
+        void setGeometry(OdomGeometry geometry);
+        /**
+         * @brief Change how local motion is integrated
+         *
+         * @param integration the integration method
+         */
+        void setIntegration(OdomIntegration integration);
+        /**
+         * @brief Get the filter that fuses the IMU and tracking wheel headings
+         *
+         * @return HeadingFilter&
+         */
+        HeadingFilter& getHeadingFilter();
+    private:
+        OdomGeometry geometry;
+        OdomIntegration integration;
+        HeadingFilter headingFilter;
+        Pose pose = {0, 0, 0};
+        Pose speed = {0, 0, 0};
+        Pose localSpeed = {0, 0, 0};
+        Pose localDelta = {0, 0, 0};
+        float distanceTraveled = 0;
+        SensorSnapshot prev;
+};
+} // namespace lemlib
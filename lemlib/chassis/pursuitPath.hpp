@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+#include "lemlib/pose.hpp"
+#include "lemlib/asset.hpp"
+
+namespace lemlib {
+/**
+ * @brief Read a path from an asset
+ *
+ * Each line of the path is "x, y, velocity", and the path ends at a line reading "endData"
+ *
+ * @param path the asset to read
+ * @return std::vector<Pose> the points on the path, with the velocity stored in theta. Empty if the path is invalid
+ */
+std::vector<Pose> getData(const asset& path);
+
+/**
+ * @brief Find the closest point on the path to the robot
+ *
+ * @param pose the current pose of the robot
+ * @param path the path to follow
+ * @return int index of the closest point
+ */
+int findClosest(const Pose& pose, const std::vector<Pose>& path);
+
+/**
+ * @brief Find where a circle around the robot intersects a line segment
+ *
+ * @param p1 start point of the segment
+ * @param p2 end point of the segment
+ * @param pose position of the robot
+ * @param lookaheadDist radius of the circle
+ * @return float how far along the segment the intersection is, from 0 to 1. -1 if there is no intersection
+ */
+float circleIntersect(const Pose& p1, const Pose& p2, const Pose& pose, float lookaheadDist);
+
+/**
+ * @brief Find the lookahead point
+ *
+ * @param lastLookahead the last lookahead point, with the index of its segment stored in theta
+ * @param pose the current position of the robot
+ * @param path the path to follow
+ * @param closest the index of the point closest to the robot
+ * @param lookaheadDist the lookahead distance
+ * @return Pose the lookahead point, with the index of its segment stored in theta
+ */
+Pose lookaheadPoint(const Pose& lastLookahead, const Pose& pose, const std::vector<Pose>& path, int closest,
+                    float lookaheadDist);
+} // namespace lemlib
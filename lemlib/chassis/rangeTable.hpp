@@ -0,0 +1,159 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "lemlib/asset.hpp"
+#include "lemlib/chassis/sensorSnapshot.hpp"
+#include "lemlib/chassis/wallCorrection.hpp"
+
+namespace lemlib {
+/**
+ * @brief The poses a range table is sampled at
+ */
+struct RangeTableGrid {
+        /** distance from the center of the field to each wall, in inches */
+        float fieldHalfSize = 71;
+        /** number of samples along x and along y, spread evenly from one wall to the other */
+        int positions = 24;
+        /** number of headings sampled, spread evenly over a full turn */
+        int headings = 180;
+        /** size of one step of the stored ranges, in inches. Ranges up to 65534 steps can be stored */
+        float resolution = 1.0 / 64;
+        /** the encoder may drop samples the ranges either side of them predict to within this, in inches */
+        float tolerance = 0.05;
+};
+
+/**
+ * @brief The distance each distance sensor should read at any pose on the field, looked up instead of calculated
+ *
+ * A beam sensor model needs the distance every sensor would read from every particle, many times each update. The
+ * table stores those distances for every sensor on a grid of poses (x, y and heading), so a query is a trilinear
+ * interpolation and doesn't need any trigonometry. The table is generated on a computer by the range table tool in
+ * tools/rangeTable, for the sensor mounts in constants.hpp, and embedded with ASSET.
+ *
+ * The distances to the walls perpendicular to x and to y are stored separately, and the closer one is taken after
+ * interpolating. Each is linear in x and y, so the interpolation is only off by the curve between two headings,
+ * rather than cutting the corner wherever the beam moves from one wall to the other.
+ *
+ * Each row of samples along x is stored as the samples the ranges between them can be interpolated from, within
+ * RangeTableGrid::tolerance, which shrinks the table many times over. load() expands the rows into memory once.
+ *
+ * @b Example
+ * @code {.cpp}
+ * ASSET(rangeTable_bin);
+ * lemlib::RangeTable rangeTable;
+ *
+ * void initialize() {
+ *     // use the table for the particle filter, if it was generated for the mounts the robot has
+ *     if (rangeTable.load(rangeTable_bin)) lemlib::setRangeTable(&rangeTable);
+ * }
+ * @endcode
+ */
+class RangeTable {
+    public:
+        /**
+         * @brief Create a new, empty RangeTable
+         */
+        RangeTable() = default;
+        /**
+         * @brief Calculate a range table from the geometry of the field
+         *
+         * @param mounts where each distance sensor is mounted, indexed by DistanceSide
+         * @param sides bit i is set if the sensor at DistanceSide i is in the table
+         * @param grid the poses to sample
+         * @return RangeTable
+         */
+        static RangeTable build(const DistanceMount* mounts, uint32_t sides, const RangeTableGrid& grid);
+        /**
+         * @brief Compress the table into the format read by load()
+         *
+         * @return std::vector<uint8_t>
+         */
+        std::vector<uint8_t> encode() const;
+        /**
+         * @brief Expand a compressed table
+         *
+         * @param file the table, as written by encode()
+         * @return true if the table was read. The table is left empty otherwise
+         */
+        bool load(const asset& file);
+        /**
+         * @brief Whether a table has been loaded or built
+         *
+         * @return true if it has
+         */
+        bool isLoaded() const;
+        /**
+         * @brief Whether the table has a sensor
+         *
+         * @param side the sensor
+         * @return true if it does
+         */
+        bool hasSensor(DistanceSide side) const;
+        /**
+         * @brief Get the mount a sensor in the table was generated for
+         *
+         * @param side the sensor. Must be in the table
+         * @return const DistanceMount&
+         */
+        const DistanceMount& getMount(DistanceSide side) const;
+        /**
+         * @brief Check that the table was made for the mounts the robot has
+         *
+         * A table made for a sensor that has since moved gives the wrong distances, so it shouldn't be used.
+         *
+         * @param mounts where each distance sensor is mounted, indexed by DistanceSide
+         * @param sides bit i is set if the sensor at DistanceSide i has to be in the table
+         * @return true if every sensor in sides is in the table, and mounted the same to within 0.01 inches and
+         * radians
+         */
+        bool matches(const DistanceMount* mounts, uint32_t sides) const;
+        /**
+         * @brief Get the distance a sensor should read
+         *
+         * @param side the sensor. Must be in the table
+         * @param x x position of the tracking center, in inches
+         * @param y y position of the tracking center, in inches
+         * @param theta heading of the robot, in radians
+         * @return float the distance to the wall the sensor faces, in inches, or INFINITY if the wall is further than
+         * the sensor's range. Poses off the field use the nearest pose on it
+         */
+        float getExpected(DistanceSide side, float x, float y, float theta) const;
+        /**
+         * @brief Get the grid the table was sampled at
+         *
+         * @return const RangeTableGrid&
+         */
+        const RangeTableGrid& getGrid() const;
+        /**
+         * @brief Get the size of the expanded table in memory
+         *
+         * @return size_t number of bytes
+         */
+        size_t getMemoryUsage() const;
+    private:
+        RangeTableGrid grid;
+        std::array<DistanceMount, DISTANCE_SIDES> mounts {};
+        /** where each sensor's samples start in ranges, or -1 if the sensor isn't in the table */
+        std::array<int, DISTANCE_SIDES> offsets = {-1, -1, -1, -1};
+        /**
+         * samples indexed by sensor, wall (perpendicular to x or to y), heading, y and then x, in steps of
+         * grid.resolution, whatever the sensor's range. OUT_OF_RANGE if too long to store
+         */
+        std::vector<uint16_t> ranges;
+};
+
+/**
+ * @brief Calculate the distance a distance sensor should read, by casting its beam at the field walls
+ *
+ * @param mount where the sensor is mounted
+ * @param x x position of the tracking center, in inches
+ * @param y y position of the tracking center, in inches
+ * @param theta heading of the robot, in radians
+ * @param fieldHalfSize distance from the center of the field to each wall, in inches
+ * @return float the distance to the wall the sensor faces, in inches, or INFINITY if it is further than the sensor's
+ * range
+ */
+float castRange(const DistanceMount& mount, float x, float y, float theta, float fieldHalfSize);
+} // namespace lemlib
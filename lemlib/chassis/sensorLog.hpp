@@ -0,0 +1,86 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include "pros/rtos.hpp"
+#include "lemlib/chassis/sensorSnapshot.hpp"
+
+namespace lemlib {
+/**
+ * @brief Records sensor snapshots to a file, for the replay and sweep tools
+ *
+ * The tracking task passes every snapshot to record(), which only copies it into a ring buffer, so odometry never
+ * waits for the SD card. A separate task writes the buffered snapshots to the file every WRITE_PERIOD ms. If the SD
+ * card falls so far behind that the buffer fills up, snapshots are dropped and counted instead.
+ *
+ * The file is the CSV format described in tools/replay/replayEngine.hpp, one line per snapshot:
+ *   time_us, vertical1, vertical2, horizontal1, horizontal2, imu_deg,
+ *   front_mm, front_confidence, back_mm, back_confidence, left_mm, left_confidence, right_mm, right_confidence
+ * Tracking wheel distances and the IMU rotation are relative to the first snapshot recorded, as if the sensors had
+ * been reset when recording started.
+ */
+class SensorLog {
+    public:
+        /** number of snapshots that can wait to be written */
+        static constexpr uint32_t CAPACITY = 256;
+        /** time between writes to the file, in milliseconds */
+        static constexpr uint32_t WRITE_PERIOD = 100;
+
+        /**
+         * @brief Start recording to a file, replacing it if it exists
+         *
+         * @param path the file, usually on the SD card
+         * @return true if the file was opened, false if it couldn't be or the log is already recording
+         *
+         * @b Example
+         * @code {.cpp}
+         * lemlib::SensorLog log;
+         * if (!log.start("/usd/sensors.csv")) std::cout << "no SD card" << std::endl;
+         * @endcode
+         */
+        bool start(const char* path);
+        /**
+         * @brief Write the snapshots still in the buffer and close the file
+         */
+        void stop();
+        /**
+         * @brief Check whether the log is recording
+         *
+         * @return true if it is
+         */
+        bool isRecording() const;
+        /**
+         * @brief Queue a snapshot to be written. Does nothing if the log isn't recording
+         *
+         * @note only one task may call this. It never blocks or allocates
+         *
+         * @param snapshot the snapshot
+         */
+        void record(const SensorSnapshot& snapshot);
+        /**
+         * @brief Get the number of snapshots dropped because the buffer was full
+         *
+         * @return uint32_t snapshots dropped since the log started
+         */
+        uint32_t getDropped() const;
+    private:
+        void write();
+
+        std::array<SensorSnapshot, CAPACITY> buffer {};
+        // record() only writes head and the writer only writes tail, so neither needs the mutex
+        std::atomic<uint32_t> head = 0;
+        std::atomic<uint32_t> tail = 0;
+        std::atomic<bool> recording = false;
+        std::atomic<uint32_t> dropped = 0;
+        // the readings the log is relative to. Only used by the writer
+        bool hasOrigin = false;
+        SensorSnapshot origin;
+        bool hasImuOrigin = false;
+        float imuOrigin = 0;
+        FILE* file = nullptr;
+        pros::Mutex mutex; // held while the file is written, opened or closed
+        pros::Task* task = nullptr;
+};
+} // namespace lemlib
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace lemlib {
+class OdomSensors;
+class Drivetrain;
+
+/**
+ * @brief The side of the robot a distance sensor faces
+ */
+enum class DistanceSide { FRONT, BACK, LEFT, RIGHT };
+
+/**
+ * @brief Number of distance sensor sides
+ */
+constexpr int DISTANCE_SIDES = 4;
+
+/**
+ * @brief Names of each DistanceSide, used by the correctAt functions
+ */
+constexpr const char* DISTANCE_SIDE_NAMES[DISTANCE_SIDES] = {"front", "back", "left", "right"};
+
+/**
+ * @brief A single distance sensor reading
+ */
+struct DistanceReading {
+        /** whether the sensor exists and returned a reading */
+        bool valid = false;
+        /** distance to the object, in millimeters */
+        int32_t distance = 0;
+        /** confidence of the reading, from 0 to 63 */
+        int32_t confidence = 0;
+};
+
+/**
+ * @brief Every odometry sensor, read once at the same time
+ *
+ * The tracking task reads each sensor exactly once per cycle and stores the result in a SensorSnapshot. Everything
+ * that needs sensor data during that cycle uses the snapshot, so each sensor is only read once and every consumer
+ * sees the same sample.
+ */
+struct SensorSnapshot {
+        /** time the snapshot was taken, in microseconds */
+        uint64_t timestamp = 0;
+        /** time since the previous snapshot, in seconds. 0 for the first snapshot */
+        float dt = 0;
+        /** distance traveled by the first vertical tracking wheel, in inches */
+        float vertical1 = 0;
+        /** distance traveled by the second vertical tracking wheel, in inches */
+        float vertical2 = 0;
+        /** distance traveled by the first horizontal tracking wheel, in inches */
+        float horizontal1 = 0;
+        /** distance traveled by the second horizontal tracking wheel, in inches */
+        float horizontal2 = 0;
+        /** whether the IMU exists and returned a reading */
+        bool imuValid = false;
+        /** rotation of the IMU, in radians. Increases clockwise */
+        float imuRotation = 0;
+        /** forward velocity measured by the vertical tracking wheels, in inches per second */
+        float forwardVelocity = 0;
+        /** yaw rate measured by the IMU, or the vertical tracking wheels if there is no IMU, in radians per second */
+        float yawRate = 0;
+        /** distance sensor readings, indexed by DistanceSide */
+        std::array<DistanceReading, DISTANCE_SIDES> distances {};
+
+        /**
+         * @brief Get the reading of the distance sensor on a side of the robot
+         *
+         * @param side the side of the robot
+         * @return const DistanceReading&
+         *
+         * @b Example
+         * @code {.cpp}
+         * lemlib::SensorSnapshot snapshot = lemlib::getSensorSnapshot();
+         * if (snapshot.distance(lemlib::DistanceSide::FRONT).valid) {
+         *     std::cout << snapshot.distance(lemlib::DistanceSide::FRONT).distance << std::endl;
+         * }
+         * @endcode
+         */
+        const DistanceReading& distance(DistanceSide side) const { return distances[static_cast<int>(side)]; }
+};
+
+/**
+ * @brief Set the sensors the snapshot is taken from
+ *
+ * This is called by setSensors(), so you don't need to call it yourself
+ *
+ * @param sensors the odometry sensors
+ * @param drivetrain the drivetrain, used for its track width
+ */
+void setSnapshotSensors(const OdomSensors& sensors, const Drivetrain& drivetrain);
+
+/**
+ * @brief Read every sensor and store the result as the latest snapshot
+ *
+ * This is called by update() at the start of every tracking cycle, so you don't need to call it yourself
+ *
+ * @return SensorSnapshot the new snapshot
+ */
+SensorSnapshot updateSensorSnapshot();
+
+/**
+ * @brief Get the latest sensor snapshot
+ *
+ * @note this is thread safe, and doesn't read any sensors
+ *
+ * @return SensorSnapshot
+ *
+ * @b Example
+ * @code {.cpp}
+ * // print the forward velocity of the robot
+ * std::cout << lemlib::getSensorSnapshot().forwardVelocity << std::endl;
+ * @endcode
+ */
+SensorSnapshot getSensorSnapshot();
+} // namespace lemlib
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include "pros/motors.hpp"
 #include "pros/motor_group.hpp"
 #include "pros/adi.hpp"
@@ -26,6 +27,18 @@ constexpr float NEW_4_HALF = 3.995;
 constexpr float OLD_4_HALF = 4.175;
 } // namespace Omniwheel
 
+/**
+ * @brief How the motors of a motor group tracking wheel are combined into one distance
+ *
+ * Each cycle, every motor reports how far it moved since the last cycle, and those movements are combined.
+ * MEDIAN and DROP_OUTLIER stop a single slipping or disconnected motor from pulling the whole wheel with it.
+ */
+enum class MotorAggregation {
+    MEAN, /** average every motor */
+    MEDIAN, /** use the median motor */
+    DROP_OUTLIER /** average every motor except the one furthest from the median */
+};
+
 class TrackingWheel {
     public:
         /**
@@ -99,6 +112,7 @@ class TrackingWheel {
          * @param wheelDiameter the diameter of the wheel
          * @param distance half the track width of the drivetrain in inches
          * @param rpm theoretical maximum rpm of the drivetrain wheels
+         * @param aggregation how the motors are combined, defaults to MotorAggregation::MEAN
          *
          * @b Example
          * @code {.cpp}
@@ -116,9 +130,13 @@ class TrackingWheel {
          * // if it was to the right of the tracking center, we would use a positive distance
          * // the rpm is 360
          * lemlib::TrackingWheel leftTrackingWheel(&leftMotors, lemlib::Omniwheel::OLD_4, -5, 360);
+         * // same as above, but ignore the motor that disagrees with the others the most
+         * lemlib::TrackingWheel robustTrackingWheel(&leftMotors, lemlib::Omniwheel::OLD_4, -5, 360,
+         *                                           lemlib::MotorAggregation::DROP_OUTLIER);
          * @endcode
          */
-        TrackingWheel(pros::MotorGroup* motors, float wheelDiameter, float distance, float rpm);
+        TrackingWheel(pros::MotorGroup* motors, float wheelDiameter, float distance, float rpm,
+                      MotorAggregation aggregation = MotorAggregation::MEAN);
         /**
          * @brief Reset the tracking wheel position to 0
          *
@@ -138,6 +156,9 @@ class TrackingWheel {
         /**
          * @brief Get the distance traveled by the tracking wheel
          *
+         * @note for motor group tracking wheels, this doesn't allocate any memory, but it does keep track of the last
+         * position of every motor. Only one task should call it
+         *
          * @return float distance traveled in inches
          *
          * @b Example
@@ -151,6 +172,23 @@ class TrackingWheel {
          * }
          */
         float getDistanceTraveled();
+        /**
+         * @brief Set how often the sensor of the tracking wheel reports its position
+         *
+         * Only rotation sensors support this, other tracking wheels ignore it.
+         * If you are using odometry provided by LemLib, this will automatically be called to match the odometry rate
+         *
+         * @param rate time between reports in milliseconds, minimum 5
+         *
+         * @b Example
+         * @code {.cpp}
+         * void initialize() {
+         *     // report every 5ms instead of every 10ms
+         *     exampleTrackingWheel.setDataRate(5);
+         * }
+         * @endcode
+         */
+        void setDataRate(uint32_t rate);
         /**
          * @brief Get the offset of the tracking wheel from the center of rotation
          *
@@ -184,7 +222,16 @@ class TrackingWheel {
          * @endcode
          */
         int getType();
+        /**
+         * @brief The maximum number of motors a motor group tracking wheel can use
+         */
+        static constexpr int MAX_MOTORS = 8;
     private:
+        /**
+         * @brief Cache the inches traveled per rotation of each motor, so the gearing isn't read every cycle
+         */
+        void cacheMotorScales();
+
         float diameter;
         float distance;
         float rpm;
@@ -192,5 +239,10 @@ class TrackingWheel {
         pros::Rotation* rotation = nullptr;
         pros::MotorGroup* motors = nullptr;
         float gearRatio = 1;
+        MotorAggregation aggregation = MotorAggregation::MEAN;
+        int motorCount = 0;
+        std::array<float, MAX_MOTORS> motorScales {};
+        std::array<double, MAX_MOTORS> prevMotorPositions {};
+        float motorDistance = 0;
 };
 } // namespace lemlib
\ No newline at end of file
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include "lemlib/pose.hpp"
+#include "lemlib/chassis/sensorSnapshot.hpp"
+
+namespace lemlib {
+/**
+ * @brief Where a distance sensor is mounted on the robot, and how noisy it is
+ *
+ * Positions are relative to the tracking center, with y pointing forwards and x pointing right
+ */
+struct DistanceMount {
+        /** distance to the right of the tracking center, in inches */
+        float x = 0;
+        /** distance in front of the tracking center, in inches */
+        float y = 0;
+        /** direction the sensor faces, in radians. 0 is forwards, increases clockwise */
+        float angle = 0;
+        /** readings further away than this are ignored, in inches */
+        float maxRange = 48;
+        /** smallest standard deviation of a reading, in inches */
+        float minNoise = 0.6;
+        /** standard deviation of a reading as a fraction of the distance */
+        float rangeNoise = 0.05;
+};
+
+/**
+ * @brief Settings for wall corrections
+ */
+struct WallCorrectionSettings {
+        /** distance from the center of the field to each wall, in inches */
+        float fieldHalfSize = 71;
+        /** readings with a lower confidence are ignored, from 0 to 63 */
+        int32_t minConfidence = 40;
+        /** readings further than this from the distance expected at the current pose are ignored, in inches */
+        float gate = 6;
+        /** readings that hit a wall at a larger angle than this are ignored, in radians */
+        float maxIncidence = 1;
+        /** whether readings further away than the maxRange of their mount are ignored */
+        bool limitRange = true;
+};
+
+/**
+ * @brief The position calculated by a wall correction
+ */
+struct WallCorrection {
+        /** whether any reading hit a wall perpendicular to the x axis */
+        bool hasX = false;
+        /** whether any reading hit a wall perpendicular to the y axis */
+        bool hasY = false;
+        /** corrected x position, in inches. Only valid if hasX is true */
+        float x = 0;
+        /** corrected y position, in inches. Only valid if hasY is true */
+        float y = 0;
+        /** number of readings used */
+        int used = 0;
+};
+
+/**
+ * @brief Calculate the position of the robot from distance sensor readings of the field walls
+ *
+ * For every reading, the beam of the sensor is cast from the current pose at the current heading to find which wall
+ * it should hit and how far away that wall should be. Readings that aren't confident enough, are out of range, hit
+ * the wall at too shallow an angle, or are too far from the expected distance (something is in the way) are
+ * rejected. Every remaining reading constrains the x or y position of the robot, and the constraints are combined
+ * with a least squares fit weighted by the noise of each sensor. The heading is not changed.
+ *
+ * This doesn't allocate memory or read any sensors, so it is cheap enough to call every update.
+ *
+ * @param pose the current pose of the robot, with theta in radians
+ * @param readings the distance sensor readings
+ * @param mounts where each sensor is mounted. Indexed the same as readings
+ * @param count number of readings
+ * @param settings the wall correction settings
+ * @param mask bit i is set if reading i may be used. All readings by default
+ * @return WallCorrection
+ */
+WallCorrection computeWallCorrection(const Pose& pose, const DistanceReading* readings, const DistanceMount* mounts,
+                                     int count, const WallCorrectionSettings& settings, uint32_t mask = UINT32_MAX);
+} // namespace lemlib
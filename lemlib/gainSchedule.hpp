@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+#include "lemlib/pid.hpp"
+
+namespace lemlib {
+/**
+ * @brief PID gains that change with the error and the velocity
+ *
+ * The gains are given on a grid of error magnitudes and velocity magnitudes, and interpolated between them. Outside the
+ * grid, the gains at its edge are used. A turn can then use gentle gains with some kI to finish a small turn, and
+ * stiffer gains with more kD to stop a large one, without a second set of controllers.
+ */
+class GainSchedule {
+    public:
+        /**
+         * @brief Create a new GainSchedule
+         *
+         * @param errors error magnitudes the gains are given at, in ascending order
+         * @param velocities velocity magnitudes the gains are given at, in ascending order
+         * @param gains the gains, one row for each error with one set of gains for each velocity
+         *
+         * @b Example
+         * @code {.cpp}
+         * lemlib::GainSchedule schedule({5, 30}, // errors, in degrees
+         *                               {0, 180}, // angular velocities, in degrees per second
+         *                               {{{1.1, 0.05, 0}, {2, 0, 10}}, // at 5 degrees, when still and when turning fast
+         *                                {{2, 0, 10}, {2, 0, 10}}}); // at 30 degrees
+         * chassis.setAngularGainSchedule(&schedule);
+         * @endcode
+         */
+        GainSchedule(std::vector<float> errors, std::vector<float> velocities,
+                     std::vector<std::vector<PIDGains>> gains);
+
+        /**
+         * @brief Check that there are gains for every error and velocity
+         *
+         * @return true if the schedule can be used
+         */
+        bool isValid() const;
+
+        /**
+         * @brief Get the gains at an error and a velocity
+         *
+         * @param error the error. Only its magnitude is used
+         * @param velocity the velocity. Only its magnitude is used
+         * @return PIDGains the interpolated gains
+         */
+        PIDGains get(float error, float velocity) const;
+    private:
+        std::vector<float> errors;
+        std::vector<float> velocities;
+        std::vector<std::vector<PIDGains>> gains;
+};
+} // namespace lemlib
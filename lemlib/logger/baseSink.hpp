@@ -50,6 +50,14 @@ class BaseSink {
          */
         void setLowestLevel(Level level);
 
+        /**
+         * @brief Get the lowest level.
+         * If this is a combined sink, this is the lowest level of its first sink.
+         *
+         * @return Level the lowest level that isn't ignored
+         */
+        Level getLowestLevel() const;
+
         /**
          * @brief Log a message at the given level
          * If this is a combined sink, this operation will
@@ -83,7 +91,7 @@ class BaseSink {
             fmt::dynamic_format_arg_store<fmt::format_context> formattingArgs = getExtraFormattingArgs(message);
 
             formattingArgs.push_back(fmt::arg("time", message.time));
-            formattingArgs.push_back(fmt::arg("level", message.level));
+            formattingArgs.push_back(fmt::arg("level", format_as(message.level)));
             formattingArgs.push_back(fmt::arg("message", messageString));
 
             std::string formattedString = fmt::vformat(logFormat, std::move(formattingArgs));
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace lemlib {
+/**
+ * @brief Runs the chunks of a loop, possibly at the same time
+ *
+ * The brain has a single core, so by default every chunk runs in order on the calling task. Builds for a computer
+ * (with LEMLIB_HOST defined) can use a ThreadPoolBackend instead, so the same loops use every core when replaying logs
+ * or tuning.
+ */
+class ParallelBackend {
+    public:
+        virtual ~ParallelBackend() = default;
+        /**
+         * @brief Run a function once for every chunk, and wait for all of them to finish
+         *
+         * @param chunks the number of chunks
+         * @param function called with the index of each chunk. Chunks may run in any order, at the same time
+         */
+        virtual void run(std::size_t chunks, const std::function<void(std::size_t chunk)>& function) = 0;
+        /**
+         * @brief Get how many chunks can run at the same time
+         *
+         * @return int
+         */
+        virtual int getConcurrency() const = 0;
+};
+
+/**
+ * @brief Runs every chunk in order on the calling task
+ */
+class SerialBackend : public ParallelBackend {
+    public:
+        void run(std::size_t chunks, const std::function<void(std::size_t chunk)>& function) override;
+        int getConcurrency() const override;
+};
+
+#ifdef LEMLIB_HOST
+/**
+ * @brief Runs chunks on a pool of threads
+ *
+ * Chunks are dealt out to each thread's queue, and threads that run out of work take chunks from the back of the
+ * other queues, so uneven chunks still keep every thread busy. The calling thread works too.
+ */
+class ThreadPoolBackend : public ParallelBackend {
+    public:
+        /**
+         * @brief Create a new ThreadPoolBackend
+         *
+         * @param threads the number of threads, including the calling thread. 0 uses every core
+         *
+         * @b Example
+         * @code {.cpp}
+         * lemlib::ThreadPoolBackend pool;
+         * lemlib::setParallelBackend(&pool);
+         * @endcode
+         */
+        ThreadPoolBackend(int threads = 0);
+        ~ThreadPoolBackend();
+        ThreadPoolBackend(const ThreadPoolBackend&) = delete;
+        ThreadPoolBackend& operator=(const ThreadPoolBackend&) = delete;
+        void run(std::size_t chunks, const std::function<void(std::size_t chunk)>& function) override;
+        int getConcurrency() const override;
+    private:
+        struct State;
+        std::unique_ptr<State> state;
+};
+#endif
+
+/**
+ * @brief Set the backend used by parallelFor, parallelReduce and inclusiveScan
+ *
+ * @param backend the backend, which must outlive its use. nullptr goes back to running in order
+ */
+void setParallelBackend(ParallelBackend* backend);
+
+/**
+ * @brief Get the backend used by parallelFor, parallelReduce and inclusiveScan
+ *
+ * @return ParallelBackend&
+ */
+ParallelBackend& getParallelBackend();
+
+/** default number of items in each chunk. Large enough that running a chunk costs far more than handing it out */
+constexpr std::size_t DEFAULT_GRAIN = 256;
+
+/**
+ * @brief Get the number of chunks a loop is split into
+ *
+ * @param count the number of items
+ * @param grain the number of items in each chunk
+ * @return std::size_t
+ */
+constexpr std::size_t chunkCount(std::size_t count, std::size_t grain) { return (count + grain - 1) / grain; }
+
+/**
+ * @brief Run a loop in chunks
+ *
+ * The chunks are the same whatever the backend, so a loop that seeds a random number generator from the chunk index
+ * gives the same results serially and in parallel.
+ *
+ * @param count the number of items
+ * @param grain the number of items in each chunk
+ * @param body called as body(begin, end, chunk) for each chunk
+ *
+ * @b Example
+ * @code {.cpp}
+ * lemlib::parallelFor(values.size(), lemlib::DEFAULT_GRAIN, [&](size_t begin, size_t end, size_t chunk) {
+ *     for (size_t i = begin; i < end; i++) values[i] *= 2;
+ * });
+ * @endcode
+ */
+template <typename F> void parallelFor(std::size_t count, std::size_t grain, F&& body) {
+    const std::size_t chunks = chunkCount(count, grain);
+    if (chunks == 1) {
+        body(std::size_t(0), count, std::size_t(0));
+        return;
+    }
+    getParallelBackend().run(chunks, [&](std::size_t chunk) {
+        const std::size_t begin = chunk * grain;
+        body(begin, std::min(begin + grain, count), chunk);
+    });
+}
+
+/**
+ * @brief Reduce a loop in chunks
+ *
+ * The chunk results are combined in order, so the result doesn't depend on the backend.
+ *
+ * @param count the number of items
+ * @param grain the number of items in each chunk
+ * @param identity the result of an empty chunk
+ * @param map called as map(begin, end, chunk) to reduce each chunk
+ * @param combine called as combine(a, b) to combine the results of two chunks
+ * @return T the combined result
+ */
+template <typename T, typename M, typename C>
+T parallelReduce(std::size_t count, std::size_t grain, T identity, M&& map, C&& combine) {
+    std::vector<T> partials(chunkCount(count, grain), identity);
+    parallelFor(count, grain,
+                [&](std::size_t begin, std::size_t end, std::size_t chunk) { partials[chunk] = map(begin, end, chunk); });
+    T result = identity;
+    for (const T& partial : partials) result = combine(result, partial);
+    return result;
+}
+
+/**
+ * @brief Replace each value with the sum of it and every value before it
+ *
+ * Each chunk is summed locally, the chunk totals are summed in order, and then each chunk adds the total of the chunks
+ * before it.
+ *
+ * @param values the values
+ * @param count the number of values
+ * @param grain the number of values in each chunk
+ */
+void inclusiveScan(double* values, std::size_t count, std::size_t grain = DEFAULT_GRAIN);
+} // namespace lemlib
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include "pros/rtos.hpp"
+#include "lemlib/taskStats.hpp"
+
+namespace lemlib {
+/**
+ * @brief Fixed rate loop helper
+ *
+ * Sleeps until the start of the next period using pros::Task::delay_until, so the time spent doing work inside the
+ * loop does not add to the period. If the loop falls behind by more than a full period, it skips the missed periods
+ * instead of running them back to back.
+ */
+class Rate {
+    public:
+        /**
+         * @brief Create a new Rate
+         *
+         * @note the first period starts as soon as the Rate is created
+         *
+         * @param period period of the loop, in milliseconds
+         *
+         * @b Example
+         * @code {.cpp}
+         * // run a loop at 100Hz
+         * lemlib::Rate rate(10);
+         * while (true) {
+         *     doWork();
+         *     rate.delay();
+         * }
+         * @endcode
+         */
+        Rate(uint32_t period);
+        /**
+         * @brief Wait until the start of the next period
+         *
+         * @return float time between the start of the previous period and the start of this one, in seconds
+         *
+         * @b Example
+         * @code {.cpp}
+         * lemlib::Rate rate(10);
+         * float dt = 0.01;
+         * while (true) {
+         *     position += velocity * dt;
+         *     dt = rate.delay();
+         * }
+         * @endcode
+         */
+        float delay();
+        /**
+         * @brief Get the period of the loop
+         *
+         * @return uint32_t period in milliseconds
+         */
+        uint32_t getPeriod() const;
+        /**
+         * @brief Start a new period now
+         */
+        void reset();
+    private:
+        uint32_t period;
+        uint32_t lastWake;
+        uint64_t lastWakeMicros;
+};
+
+/**
+ * @brief A task that runs a callback at a fixed rate
+ *
+ * The callback is passed the measured time since the previous call, in seconds, so it doesn't need to assume the
+ * nominal period. Execution time, period and jitter are recorded in a TaskStats.
+ */
+class PeriodicTask {
+    public:
+        /**
+         * @brief Create a new PeriodicTask
+         *
+         * @note the task doesn't run until start() is called
+         *
+         * @param name name of the task, used for timing reports. Must outlive the PeriodicTask
+         * @param period period of the task, in milliseconds
+         * @param callback function to run every period. Passed the measured time since the last call, in seconds
+         *
+         * @b Example
+         * @code {.cpp}
+         * lemlib::PeriodicTask intakeTask("intake", 10, [](float dt) {
+         *     runIntake(dt);
+         * });
+         * intakeTask.start();
+         * @endcode
+         */
+        PeriodicTask(const char* name, uint32_t period, std::function<void(float)> callback);
+        ~PeriodicTask();
+        PeriodicTask(const PeriodicTask&) = delete;
+        PeriodicTask& operator=(const PeriodicTask&) = delete;
+        /**
+         * @brief Start running the task. Does nothing if the task is already running
+         */
+        void start();
+        /**
+         * @brief Get the period of the task
+         *
+         * @return uint32_t period in milliseconds
+         */
+        uint32_t getPeriod() const;
+        /**
+         * @brief Get the timing statistics of the task
+         *
+         * @return const TaskStats&
+         */
+        const TaskStats& getStats() const;
+    private:
+        void loop();
+
+        const uint32_t period;
+        std::function<void(float)> callback;
+        TaskStats stats;
+        std::unique_ptr<pros::Task> task;
+};
+} // namespace lemlib
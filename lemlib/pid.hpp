@@ -1,8 +1,34 @@
 #pragma once
 
+#include <functional>
+
 namespace lemlib {
+/**
+ * @brief The gains of a PID
+ */
+struct PIDGains {
+        float kP;
+        float kI;
+        float kD;
+};
+
+/**
+ * @brief A PID controller
+ *
+ * The gains are per PID::NOMINAL_PERIOD, the period chassis motions and subsystems run at, so gains tuned with a fixed
+ * 10ms loop keep working. When update() is given the measured time since the last update, the integral and derivative
+ * are scaled by how long it actually was, so the controller behaves the same if the loop runs late, or at a different
+ * rate altogether.
+ *
+ * Optionally, the derivative can be low pass filtered, the output can be limited (which also stops the integral from
+ * winding up while the output is saturated), and a feedforward can be added to the output.
+ */
 class PID {
     public:
+        /**
+         * @brief the period the gains are tuned for, in seconds
+         */
+        static constexpr float NOMINAL_PERIOD = 0.01;
         /**
          * @brief Construct a new PID
          *
@@ -25,7 +51,7 @@ class PID {
         PID(float kP, float kI, float kD, float windupRange = 0, bool signFlipReset = false);
 
         /**
-         * @brief Update the PID
+         * @brief Update the PID, assuming NOMINAL_PERIOD has passed since the last update
          *
          * @param error target minus position - AKA error
          * @return float output
@@ -43,6 +69,101 @@ class PID {
          */
         float update(float error);
 
+        /**
+         * @brief Update the PID
+         *
+         * @param error target minus position - AKA error
+         * @param dt time since the last update, in seconds
+         * @return float output
+         *
+         * @b Example
+         * @code {.cpp}
+         * lemlib::Rate rate(10);
+         * float dt = 0.01;
+         * while (true) {
+         *     motor.move(pid.update(target - getPosition(), dt));
+         *     dt = rate.delay();
+         * }
+         * @endcode
+         */
+        float update(float error, float dt);
+
+        /**
+         * @brief Update the PID from a target and a measurement
+         *
+         * Unless disabled with setDerivativeOnMeasurement(), the derivative is taken of the measurement instead of
+         * the error, so a sudden change of the target doesn't kick the output. The feedforward, if any, is added.
+         *
+         * @param target where the system should be
+         * @param measurement where the system is
+         * @param dt time since the last update, in seconds
+         * @return float output
+         *
+         * @b Example
+         * @code {.cpp}
+         * pid.setOutputLimits(-127, 127);
+         * pid.setFeedforward([](float target, float measurement) { return kG * std::cos(measurement); });
+         * motor.move(pid.update(target, getAngle(), dt));
+         * @endcode
+         */
+        float update(float target, float measurement, float dt);
+
+        /**
+         * @brief Change the gains. Takes effect on the next update
+         *
+         * The integral is kept already multiplied by kI, so changing kI only changes how fast it grows from here on,
+         * and the output doesn't jump when the gains are scheduled during a motion
+         *
+         * @param gains the new gains
+         *
+         * @b Example
+         * @code {.cpp}
+         * // gentler gains for the last few degrees of a turn
+         * if (std::fabs(error) < 5) pid.setGains({1.1, 0.05, 0});
+         * @endcode
+         */
+        void setGains(PIDGains gains);
+
+        /**
+         * @brief Get the gains
+         *
+         * @return PIDGains the gains
+         */
+        PIDGains getGains() const;
+
+        /**
+         * @brief Limit the output. The integral doesn't grow while the output is held at a limit
+         *
+         * @param min lowest output
+         * @param max highest output
+         */
+        void setOutputLimits(float min, float max);
+
+        /**
+         * @brief Low pass filter the derivative, so it doesn't amplify sensor noise as much
+         *
+         * @param timeConstant time constant of the filter, in seconds. 0 disables the filter
+         */
+        void setDerivativeFilter(float timeConstant);
+
+        /**
+         * @brief Choose whether update(target, measurement, dt) takes the derivative of the measurement or of the error
+         *
+         * The derivative of the measurement doesn't kick when the target jumps, but when the target moves smoothly,
+         * e.g. along a motion profile, the derivative of the error is better, since it damps the difference from the
+         * target's velocity instead of all motion
+         *
+         * @param onMeasurement true for the measurement (the default), false for the error
+         */
+        void setDerivativeOnMeasurement(bool onMeasurement);
+
+        /**
+         * @brief Add a feedforward to the output of update(target, measurement, dt)
+         *
+         * @param feedforward function of the target and the measurement. nullptr removes it
+         */
+        void setFeedforward(std::function<float(float target, float measurement)> feedforward);
+
         /**
          * @brief reset integral, derivative, and prevTime
          *
@@ -62,15 +183,34 @@ class PID {
         void reset();
     protected:
         // gains
-        const float kP;
-        const float kI;
-        const float kD;
+        float kP;
+        float kI;
+        float kD;
 
         // optimizations
         const float windupRange;
         const bool signFlipReset;
+        float minOutput;
+        float maxOutput;
+        float derivativeTimeConstant = 0;
+        bool derivativeOnMeasurement = true;
+        std::function<float(float, float)> feedforward = nullptr;
 
-        float integral = 0;
+        float integral = 0; // already multiplied by kI
         float prevError = 0;
+        float prevMeasurement = 0;
+        float derivative = 0;
+        bool firstUpdate = true;
+
+        /**
+         * @brief the part of the update common to every overload
+         *
+         * @param error target minus measurement
+         * @param change how much the error changed since the last update
+         * @param dt time since the last update, in seconds
+         * @param feedforward added to the output
+         * @return float output
+         */
+        float calculate(float error, float change, float dt, float feedforward);
 };
-} // namespace lemlib
\ No newline at end of file
+} // namespace lemlib
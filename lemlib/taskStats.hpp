@@ -0,0 +1,278 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace lemlib {
+/**
+ * @brief Fixed size histogram of durations, in microseconds
+ *
+ * The histogram has a fixed number of equally sized buckets. The last bucket also collects every sample that is
+ * larger than the range covered by the histogram.
+ *
+ * @note only one task may record into a histogram, but any task may read from it at any time. Samples are stored in
+ * atomics so reading never blocks the task doing the recording. Any task may also call reset(), which the recording
+ * task carries out before its next sample, so a reset never races with a sample being recorded
+ */
+class TimingHistogram {
+    public:
+        /** number of buckets in the histogram */
+        static constexpr int BUCKETS = 16;
+        /**
+         * @brief Create a new timing histogram
+         *
+         * @param bucketWidth width of each bucket, in microseconds
+         *
+         * @b Example
+         * @code {.cpp}
+         * // histogram covering 0-16ms in 1ms buckets
+         * lemlib::TimingHistogram histogram(1000);
+         * @endcode
+         */
+        TimingHistogram(uint32_t bucketWidth);
+        /**
+         * @brief Record a sample
+         *
+         * @param time the duration to record, in microseconds
+         *
+         * @b Example
+         * @code {.cpp}
+         * const uint64_t start = pros::micros();
+         * doWork();
+         * histogram.record(pros::micros() - start);
+         * @endcode
+         */
+        void record(uint32_t time);
+        /**
+         * @brief Get the number of samples in a bucket
+         *
+         * @param bucket the index of the bucket, from 0 to BUCKETS - 1
+         * @return uint32_t number of samples
+         */
+        uint32_t getBucket(int bucket) const;
+        /**
+         * @brief Get the width of each bucket
+         *
+         * @return uint32_t width in microseconds
+         */
+        uint32_t getBucketWidth() const;
+        /**
+         * @brief Get the number of samples recorded
+         *
+         * @return uint32_t number of samples
+         */
+        uint32_t getCount() const;
+        /**
+         * @brief Get the smallest sample recorded
+         *
+         * @return uint32_t time in microseconds, 0 if no samples have been recorded
+         */
+        uint32_t getMin() const;
+        /**
+         * @brief Get the largest sample recorded
+         *
+         * @return uint32_t time in microseconds
+         */
+        uint32_t getMax() const;
+        /**
+         * @brief Get the average of all samples recorded
+         *
+         * @return float time in microseconds
+         */
+        float getMean() const;
+        /**
+         * @brief Estimate a percentile from the buckets
+         *
+         * @param percentile the percentile to estimate, from 0 to 1
+         * @return uint32_t upper edge of the bucket containing the percentile, in microseconds
+         *
+         * @b Example
+         * @code {.cpp}
+         * // 99% of samples were at most this long
+         * const uint32_t p99 = histogram.getPercentile(0.99);
+         * @endcode
+         */
+        uint32_t getPercentile(float percentile) const;
+        /**
+         * @brief Clear all samples
+         *
+         * The samples are cleared by the recording task, just before it records the next one. Until then, the old
+         * samples can still be read
+         */
+        void reset();
+    private:
+        void clear();
+
+        const uint32_t bucketWidth;
+        std::array<std::atomic<uint32_t>, BUCKETS> buckets;
+        std::atomic<uint32_t> count = 0;
+        // 64 bits, as 32 bits of microseconds overflow after about 71 minutes of samples
+        std::atomic<uint64_t> sum = 0;
+        std::atomic<uint32_t> min = UINT32_MAX;
+        std::atomic<uint32_t> max = 0;
+        std::atomic<bool> resetPending = false;
+};
+
+/**
+ * @brief Timing statistics for a periodic task
+ *
+ * Keeps track of how long each cycle of a task takes to execute, the actual period between cycles, how far that
+ * period strays from the nominal period (jitter), and how many times the task overran its period.
+ *
+ * Every TaskStats registers itself on construction so that it shows up in printTimingReport() and
+ * logTimingTelemetry()
+ */
+class TaskStats {
+    public:
+        /**
+         * @brief Create a new TaskStats
+         *
+         * @param name name of the task, shown in reports. Must outlive the TaskStats
+         * @param period nominal period of the task, in milliseconds
+         *
+         * @b Example
+         * @code {.cpp}
+         * lemlib::TaskStats stats("intake", 10);
+         * pros::Task task([&]() {
+         *     while (true) {
+         *         stats.beginCycle();
+         *         runIntake();
+         *         stats.endCycle();
+         *         pros::delay(10);
+         *     }
+         * });
+         * @endcode
+         */
+        TaskStats(const char* name, uint32_t period);
+        ~TaskStats();
+        TaskStats(const TaskStats&) = delete;
+        TaskStats& operator=(const TaskStats&) = delete;
+        /**
+         * @brief Mark the start of a cycle
+         *
+         * Records the period and jitter since the previous cycle started
+         */
+        void beginCycle();
+        /**
+         * @brief Mark the end of a cycle
+         *
+         * Records the execution time of the cycle, and counts an overrun if it took longer than the period
+         */
+        void endCycle();
+        /**
+         * @brief Set the nominal period of the task
+         *
+         * @param period period in milliseconds
+         */
+        void setPeriod(uint32_t period);
+        /**
+         * @brief Get the nominal period of the task
+         *
+         * @return uint32_t period in milliseconds
+         */
+        uint32_t getPeriod() const;
+        /**
+         * @brief Get the name of the task
+         *
+         * @return const char*
+         */
+        const char* getName() const;
+        /**
+         * @brief Get the number of cycles completed
+         *
+         * @return uint32_t
+         */
+        uint32_t getCycles() const;
+        /**
+         * @brief Get the number of cycles that took longer than the period to execute
+         *
+         * @return uint32_t
+         */
+        uint32_t getOverruns() const;
+        /**
+         * @brief Get the histogram of the time between the start of consecutive cycles
+         */
+        const TimingHistogram& getPeriodHistogram() const;
+        /**
+         * @brief Get the histogram of how far the period strays from the nominal period
+         */
+        const TimingHistogram& getJitterHistogram() const;
+        /**
+         * @brief Get the histogram of how long each cycle takes to execute
+         */
+        const TimingHistogram& getExecutionHistogram() const;
+        /**
+         * @brief Clear all statistics
+         *
+         * Like TimingHistogram::reset(), the statistics are cleared by the task being measured, when its next cycle
+         * begins
+         */
+        void reset();
+    private:
+        const char* name;
+        std::atomic<uint32_t> period;
+        TimingHistogram periodHistogram;
+        TimingHistogram jitterHistogram;
+        TimingHistogram executionHistogram;
+        std::atomic<uint32_t> cycles = 0;
+        std::atomic<uint32_t> overruns = 0;
+        uint64_t cycleStart = 0;
+        uint64_t prevCycleStart = 0;
+        std::atomic<bool> resetPending = false;
+};
+
+/**
+ * @brief Measure the execution time of a scope
+ *
+ * Calls TaskStats::beginCycle on construction and TaskStats::endCycle on destruction
+ *
+ * @b Example
+ * @code {.cpp}
+ * while (true) {
+ *     {
+ *         lemlib::ScopedTimer timer(stats);
+ *         doWork();
+ *     } // execution time is recorded here
+ *     pros::delay(10);
+ * }
+ * @endcode
+ */
+class ScopedTimer {
+    public:
+        ScopedTimer(TaskStats& stats);
+        ~ScopedTimer();
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+    private:
+        TaskStats& stats;
+};
+
+/**
+ * @brief Print a timing report of every registered task to the terminal
+ *
+ * @b Example
+ * @code {.cpp}
+ * void disabled() {
+ *     // print how long each task took during the match
+ *     lemlib::printTimingReport();
+ * }
+ * @endcode
+ */
+void printTimingReport();
+
+/**
+ * @brief Send the timing statistics of every registered task through the telemetry sink
+ *
+ * One message is sent per task, in the format
+ * `TIMING,name,cycles,overruns,periodMean,periodMax,jitterP99,execMean,execP99,execMax` where all times are in
+ * microseconds. The messages are sent at Level::INFO, so the telemetry sink's lowest level has to be INFO or lower
+ *
+ * @b Example
+ * @code {.cpp}
+ * lemlib::telemetrySink()->setLowestLevel(lemlib::Level::INFO);
+ * lemlib::logTimingTelemetry();
+ * @endcode
+ */
+void logTimingTelemetry();
+} // namespace lemlib
@@ -0,0 +1,100 @@
+#pragma once
+
+namespace lemlib {
+/**
+ * @brief A trapezoidal motion profile, generated one step at a time
+ *
+ * Every step moves the setpoint towards the goal, accelerating at up to the max acceleration until it reaches the max
+ * velocity, and decelerating in time to stop at the goal. The goal can be changed at any time, and the profile carries
+ * on from the velocity the setpoint already has, so a mechanism can be sent somewhere else in the middle of a move
+ * without jerking.
+ *
+ * Positions can be in any unit, as long as velocities are in that unit per second and accelerations in that unit per
+ * second squared.
+ */
+class TrapezoidProfile {
+    public:
+        /**
+         * @brief Create a new TrapezoidProfile, at rest at 0
+         *
+         * @param maxVelocity max velocity of the setpoint, in units per second
+         * @param maxAcceleration max acceleration and deceleration of the setpoint, in units per second squared
+         *
+         * @b Example
+         * @code {.cpp}
+         * // an arm that can move at 300 degrees per second, and get there in a fifth of a second
+         * lemlib::TrapezoidProfile profile(300, 1500);
+         * profile.reset(rotation.get_position() / 100.0);
+         * profile.setGoal(90);
+         * while (!profile.isDone()) {
+         *     profile.update(0.01);
+         *     motor.move(kV * profile.getVelocity() + pid.update(profile.getPosition() - getArmAngle()));
+         *     pros::delay(10);
+         * }
+         * @endcode
+         */
+        TrapezoidProfile(float maxVelocity, float maxAcceleration);
+        /**
+         * @brief Move the setpoint, and make it the goal
+         *
+         * @param position new position of the setpoint
+         * @param velocity new velocity of the setpoint. It will slow down to stop at position
+         */
+        void reset(float position, float velocity = 0);
+        /**
+         * @brief Set where the setpoint should stop
+         *
+         * @param goal the goal
+         */
+        void setGoal(float goal);
+        /**
+         * @brief Set the max velocity. If the setpoint is faster, it slows down at the max acceleration
+         *
+         * @param maxVelocity max velocity, in units per second
+         */
+        void setMaxVelocity(float maxVelocity);
+        /**
+         * @brief Move the setpoint towards the goal
+         *
+         * @param dt time since the last update, in seconds
+         */
+        void update(float dt);
+        /**
+         * @brief Get the position of the setpoint
+         *
+         * @return float
+         */
+        float getPosition() const;
+        /**
+         * @brief Get the velocity of the setpoint
+         *
+         * @return float units per second
+         */
+        float getVelocity() const;
+        /**
+         * @brief Get the acceleration of the setpoint during the last update
+         *
+         * @return float units per second squared
+         */
+        float getAcceleration() const;
+        /**
+         * @brief Get the goal
+         *
+         * @return float
+         */
+        float getGoal() const;
+        /**
+         * @brief Whether the setpoint has stopped at the goal
+         *
+         * @return true if it has
+         */
+        bool isDone() const;
+    private:
+        float maxVelocity;
+        float maxAcceleration;
+        float goal = 0;
+        float position = 0;
+        float velocity = 0;
+        float acceleration = 0;
+};
+} // namespace lemlib
@@ -0,0 +1,30 @@
+/*
+ * map.h
+ * The map of the field the particle filter localizes in: its landmarks and the walls around it.
+ */
+
+#ifndef MAP_H_
+#define MAP_H_
+
+#include <vector>
+
+class Map {
+public:
+
+	struct single_landmark_s {
+
+		int id_i;	// Landmark ID
+		float x_f;	// Landmark x-position in the map (global coordinates) [in]
+		float y_f;	// Landmark y-position in the map (global coordinates) [in]
+	};
+
+	std::vector<single_landmark_s> landmark_list;	// List of landmarks in the map
+
+	// Position of the field walls (global coordinates) [in]
+	double min_x = 0;
+	double max_x = 0;
+	double min_y = 0;
+	double max_y = 0;
+};
+
+#endif /* MAP_H_ */
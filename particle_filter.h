@@ -8,6 +8,8 @@
 #define PARTICLE_FILTER_H_
 
 #include "helper_functions.h"
+#include <cstdint>
+#include <functional>
 #include <random>
 
 struct Particle {
@@ -47,9 +49,41 @@ public:
 	//random number generator
 	std::default_random_engine gen;
 
+	// Prefix sum of the weights, and the particles being resampled. Kept between
+	// calls so resampling doesn't allocate
+	std::vector<double> cumulative;
+	std::vector<Particle> resampled;
+
+	// Augmented MCL. Short and long term averages of how well the particles explain the
+	// observations. When the short term average drops below the long term one, the robot has
+	// probably been moved without the odometry seeing it (e.g. shoved by another robot), so
+	// resample() replaces some particles with random ones until the filter finds the robot again
+	double w_slow;
+	double w_fast;
+	// how quickly each average follows the likelihood, in (0, 1]. alpha_slow should be much smaller
+	double alpha_slow;
+	double alpha_fast;
+	// particles are only injected once w_fast drops below this fraction of w_slow, so the normal
+	// noise in the likelihood doesn't keep scattering particles
+	double injection_threshold;
+	// most particles that may be replaced in one resample, as a fraction of num_particles. This
+	// bounds the cost of recovering
+	double max_injection;
+	// standard deviation of the heading of an injected particle around the particle it replaces
+	// [rad]. The heading comes from the IMU, which isn't fooled by being pushed
+	double injection_std_theta;
+	// the region injected particles are drawn from, copied from the map in updateWeights
+	double field_min_x, field_max_x, field_min_y, field_max_y;
+	// particles injected by the last resample, and how long injecting them took [us]
+	int injected;
+	uint64_t injection_time;
+
 	// Constructor
 	// @param M Number of particles
-	ParticleFilter() : num_particles(0), is_initialized(false) {}
+	ParticleFilter()
+	    : num_particles(0), is_initialized(false), w_slow(0), w_fast(0), alpha_slow(0.001), alpha_fast(0.1),
+	      injection_threshold(0.5), max_injection(0.2), injection_std_theta(0.05), field_min_x(0), field_max_x(0), field_min_y(0),
+	      field_max_y(0), injected(0), injection_time(0) {}
 
 	Pose getBestParticlePose() const;
 	
@@ -64,8 +98,9 @@ public:
 	 * @param theta Initial orientation [rad]
 	 * @param std[] Array of dimension 3 [standard deviation of x [m], standard deviation of y [m]
 	 *   standard deviation of yaw [rad]]
+	 * @param count Number of particles
 	 */
-	void init(double x, double y, double theta, double std[]);
+	void init(double x, double y, double theta, double std[], int count = 729);
 
 	/**
 	 * prediction Predicts the state for the next time step
@@ -88,21 +123,45 @@ public:
 	
 	/**
 	 * updateWeights Updates the weights for each particle based on the likelihood of the 
-	 *   observed measurements. 
+	 *   observed measurements. Also updates w_slow and w_fast from the
+	 *   mean likelihood of each observation.
 	 * @param sensor_range Range [m] of sensor
 	 * @param std_landmark[] Array of dimension 2 [standard deviation of range [m],
 	 *   standard deviation of bearing [rad]]
 	 * @param observations Vector of landmark observations
 	 * @param map Map class containing map landmarks
 	 */
-	void updateWeights(double sensor_range, double std_landmark[], std::vector<LandmarkObs> observations,
-			Map map_landmarks);
+	void updateWeights(double sensor_range, double std_landmark[], const std::vector<LandmarkObs>& observations,
+			const Map& map_landmarks);
+
+	/**
+	 * updateWeights Updates the weights for each particle from any measurement
+	 *   model, e.g. comparing distance sensor ranges to the ranges expected from
+	 *   each particle. Also updates w_slow and w_fast like the overload above.
+	 * @param likelihood Likelihood of the observations, given a particle. Called
+	 *   from several threads at once if a parallel backend is set
+	 * @param observation_count Number of observations the likelihood is a product of
+	 * @param map Map class containing map landmarks, for the field bounds
+	 */
+	void updateWeights(const std::function<double(const Particle&)>& likelihood, int observation_count,
+			const Map& map_landmarks);
 	
 	/**
 	 * resample Resamples from the updated set of particles to form
-	 *   the new set of particles.
+	 *   the new set of particles. Uses systematic resampling over the
+	 *   prefix sum of the weights, so every stage can run in parallel.
+	 *   Then replaces up to max_injection of the particles with random
+	 *   ones, if the likelihood has dropped (see w_slow and w_fast).
 	 */
 	void resample();
+
+	/**
+	 * injectRandomParticles Replaces particles with ones drawn uniformly over
+	 *   the field, keeping their heading, when w_fast has dropped below
+	 *   injection_threshold * w_slow. Called by resample(). Sets injected
+	 *   and injection_time.
+	 */
+	void injectRandomParticles();
 	
 	/*
 	 * write Writes particle positions to a file.
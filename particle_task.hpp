@@ -2,6 +2,8 @@
 #include "map.h"
 #include "particle_filter.h"
 #include "lemlib/chassis/chassis.hpp"
+#include "lemlib/chassis/localization.hpp"
+#include "lemlib/periodicTask.hpp"
 #include "pros/rtos.hpp"
 #include <vector>
 
@@ -12,14 +14,27 @@ class ParticleTask {
     lemlib::Chassis& chassis ;
     Map& map;
 public:
-    ParticleTask(lemlib::Chassis& chassis, Map& map) : chassis(chassis), map(map) {}
+    ParticleTask(lemlib::Chassis& chassis, Map& map)
+        : chassis(chassis), map(map), task("particle", 20, [this](float dt) { taskLoop(dt); }) {}
     void init(double x, double y, double theta);
 
     void start();
 
+    // change the filter tuning. The particle count and initial noise apply from the next init
+    void setSettings(const lemlib::ParticleFilterSettings& settings) { this->settings = settings; }
+
 private:
     ParticleFilter pf;
-    pros::Task* task_ptr = nullptr;
+    lemlib::ParticleFilterSettings settings = [] {
+        lemlib::ParticleFilterSettings settings;
+        settings.initialNoise = {1.0, 1.0, 0.05};
+        settings.motionNoise = {0.05, 0.05, 0.01};
+        settings.landmarkNoise = {0.3, 0.3};
+        settings.sensorRange = 50.0;
+        return settings;
+    }();
+    lemlib::PeriodicTask task; // runs taskLoop at 50 Hz
 
-    void taskLoop(); 
+    // one step of the filter, delta_t is the measured time since the last step in seconds
+    void taskLoop(double delta_t);
 };
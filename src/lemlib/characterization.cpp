@@ -0,0 +1,57 @@
+#define FMT_HEADER_ONLY
+#include "fmt/format.h"
+#include "lemlib/characterization.hpp"
+#include "lemlib/logger/logger.hpp"
+#include "lemlib/periodicTask.hpp"
+#include "pros/rtos.hpp"
+
+namespace lemlib {
+// samples per line of the log. The telemetry sink sends a line at a time, so fewer, longer lines log faster
+constexpr int SAMPLES_PER_LINE = 8;
+
+Characterization::Characterization(std::string name, std::function<void(float power)> setPower,
+                                   std::function<float()> getPosition)
+    : name(std::move(name)),
+      setPower(std::move(setPower)),
+      getPosition(std::move(getPosition)) {
+    samples.reserve(MAX_SAMPLES);
+}
+
+int Characterization::run(CharacterizationTest test, bool forwards, float power, int timeout, float maxTravel) {
+    samples.clear();
+    const float direction = forwards ? 1 : -1;
+    const float startPosition = getPosition();
+    const uint32_t start = pros::millis();
+    Rate rate(PERIOD);
+    while (samples.size() < MAX_SAMPLES) {
+        const uint32_t time = pros::millis() - start;
+        const float position = getPosition();
+        if (time > uint32_t(timeout) || std::fabs(position - startPosition) >= maxTravel) break;
+        // the power during the step that ends at the next sample
+        float output = test == CharacterizationTest::QUASISTATIC ? power * time / 1000.0f : power;
+        output = direction * std::fmin(output, 127.0f);
+        setPower(output);
+        samples.push_back({time, output, position});
+        rate.delay();
+    }
+    setPower(0);
+
+    std::string testName = test == CharacterizationTest::QUASISTATIC ? "quasistatic" : "dynamic";
+    log(testName + (forwards ? "-forward" : "-backward"));
+    return samples.size();
+}
+
+void Characterization::log(const std::string& test) const {
+    // the sink drops anything below WARN by default, so let INFO through while the records are sent
+    const Level lowestLevel = telemetrySink()->getLowestLevel();
+    telemetrySink()->setLowestLevel(Level::INFO);
+    for (size_t i = 0; i < samples.size(); i += SAMPLES_PER_LINE) {
+        std::string line = fmt::format("CHAR,{},{}", name, test);
+        for (size_t j = i; j < samples.size() && j < i + SAMPLES_PER_LINE; j++) {
+            line += fmt::format(",{},{:.1f},{:.3f}", samples[j].time, samples[j].power, samples[j].position);
+        }
+        telemetrySink()->info("{}", line);
+    }
+    telemetrySink()->setLowestLevel(lowestLevel);
+}
+} // namespace lemlib
@@ -6,6 +6,8 @@
 #include "lemlib/util.hpp"
 #include "lemlib/chassis/chassis.hpp"
 #include "lemlib/chassis/odom.hpp"
+#include "lemlib/chassis/sensorSnapshot.hpp"
+#include "lemlib/chassis/localization.hpp"
 #include "lemlib/chassis/trackingWheel.hpp"
 #include "pros/rtos.hpp"
 #include <random>
@@ -14,13 +16,10 @@
 
 ParticleFilter pf; // Particle filter
 std::default_random_engine gen;
-double sigma_pos[3] = {1, 1, 0.01}; // GPS measurement uncertainty [x [inches], y [inches], theta [rad]]
-double sigma_landmark[2] = {1, 1}; // Landmark measurement uncertainty [x [inches], y [inches]]
-extern Map map;
 
 lemlib::OdomSensors::OdomSensors(TrackingWheel* vertical1, TrackingWheel* vertical2, TrackingWheel* horizontal1,
                                  TrackingWheel* horizontal2, pros::Imu* imu,
-                                 std::unordered_map<std::string, std::shared_ptr<pros::Distance>>* distances)
+                                 DistanceSensorRegistry* distances)
     : vertical1(vertical1),
       vertical2(vertical2),
       horizontal1(horizontal1),
@@ -89,10 +88,12 @@ void lemlib::Chassis::calibrate(bool calibrateImu) {
     // initialize odom
     if (sensors.vertical1 == nullptr)
         sensors.vertical1 = new lemlib::TrackingWheel(drivetrain.leftMotors, drivetrain.wheelDiameter,
-                                                      -(drivetrain.trackWidth / 2), drivetrain.rpm);
+                                                      -(drivetrain.trackWidth / 2), drivetrain.rpm,
+                                                      lemlib::MotorAggregation::DROP_OUTLIER);
     if (sensors.vertical2 == nullptr)
         sensors.vertical2 = new lemlib::TrackingWheel(drivetrain.rightMotors, drivetrain.wheelDiameter,
-                                                      drivetrain.trackWidth / 2, drivetrain.rpm);
+                                                      drivetrain.trackWidth / 2, drivetrain.rpm,
+                                                      lemlib::MotorAggregation::DROP_OUTLIER);
     sensors.vertical1->reset();
     sensors.vertical2->reset();
     if (sensors.horizontal1 != nullptr) sensors.horizontal1->reset();
@@ -105,12 +106,8 @@ void lemlib::Chassis::calibrate(bool calibrateImu) {
 
 void lemlib::Chassis::setPose(float x, float y, float theta, bool radians) {
     lemlib::setPose(lemlib::Pose(x, y, theta), radians);
-    std::normal_distribution<double> N_x_init(x, sigma_pos[0]);
-    std::normal_distribution<double> N_y_init(y, sigma_pos[1]);
-    std::normal_distribution<double> N_theta_init(theta, sigma_pos[2]);
-
-    // Initialize particle filter if this is the first time step.
-    pf.init(N_x_init(gen), N_y_init(gen), N_theta_init(gen), sigma_pos);
+    // Initialize particle filter around the new pose. The filter works in radians
+    seedParticleFilter(pf, getParticleFilterSettings(), lemlib::getPose(true), gen);
 }
 
 void lemlib::Chassis::correctAt0(std::set<std::string> sensors) { lemlib::correctAt0(sensors); }
@@ -123,6 +120,10 @@ void lemlib::Chassis::correctAt270(std::set<std::string> sensors) { lemlib::corr
 
 void lemlib::Chassis::correctByDistanceSensors() { lemlib::correctByDistanceSensors(); }
 
+lemlib::GlobalLocalization lemlib::Chassis::localize(Pose hint, bool radians) {
+    return lemlib::localize(hint, radians);
+}
+
 void lemlib::Chassis::setPose(Pose pose, bool radians) { lemlib::setPose(pose, radians); }
 
 lemlib::Pose lemlib::Chassis::getPose(bool radians, bool standardPos) {
@@ -186,56 +187,43 @@ void lemlib::Chassis::setBrakeMode(pros::motor_brake_mode_e mode) {
     drivetrain.leftMotors->set_brake_mode_all(mode);
     drivetrain.rightMotors->set_brake_mode_all(mode);
 }
-double lemlib::Chassis::getForwardVelocity() {
-    double now = pros::millis() / 1000.0;
-    double dt = now - prev_time;
-    if (dt <= 0) dt = 0.02;
-
-    double delta_distance = 0;
-
-    if (sensors.vertical1 && sensors.vertical2) {
-        double left_pos = sensors.vertical1->getDistanceTraveled();
-        double right_pos = sensors.vertical2->getDistanceTraveled();
-        delta_distance = ( (left_pos - prev_left) + (right_pos - prev_right) ) / 2.0;
-        prev_left = left_pos;
-        prev_right = right_pos;
-    } else if (sensors.vertical1) {
-        double left_pos = sensors.vertical1->getDistanceTraveled();
-        delta_distance = left_pos - prev_left;
-        prev_left = left_pos;
-    } else if (sensors.vertical2) {
-        double right_pos = sensors.vertical2->getDistanceTraveled();
-        delta_distance = right_pos - prev_right;
-        prev_right = right_pos;
-    } else {
-        delta_distance = 0; // no wheel info available
-    }
+bool lemlib::Chassis::setAngularGainSchedule(const GainSchedule* schedule) {
+    if (schedule != nullptr && !schedule->isValid()) return false;
+    angularSchedule = schedule;
+    return true;
+}
 
-    prev_time = now;
-    return delta_distance / dt;
-}
-
-double lemlib::Chassis::getYawRate() {
-    double now = pros::millis() / 1000.0;
-    double dt = now - prev_time;
-    if (dt <= 0) dt = 0.02;
-
-    double delta_yaw = 0;
-
-    if (sensors.imu) {
-        double yaw = sensors.imu->get_rotation();
-        delta_yaw = (yaw - prev_yaw) * M_PI / 180.0; // convert to radians
-        prev_yaw = yaw;
-    } else if (sensors.vertical1 && sensors.vertical2) {
-        double left_pos = sensors.vertical1->getDistanceTraveled();
-        double right_pos = sensors.vertical2->getDistanceTraveled();
-        delta_yaw = ((right_pos - prev_right) - (left_pos - prev_left)) / drivetrain.trackWidth;
-        prev_left = left_pos;
-        prev_right = right_pos;
-    } else {
-        delta_yaw = 0; // no yaw info available
-    }
+void lemlib::Chassis::scheduleAngularGains(float error) {
+    if (angularSchedule == nullptr) return;
+    angularPID.setGains(angularSchedule->get(error, radToDeg(getYawRate())));
+}
 
-    prev_time = now;
-    return delta_yaw / dt;
+void lemlib::Chassis::resetAngularGains() {
+    angularPID.setGains({angularSettings.kP, angularSettings.kI, angularSettings.kD});
 }
+
+void lemlib::Chassis::setTurnProfile(TurnProfileSettings settings) { turnProfile = settings; }
+
+bool lemlib::Chassis::startTurnProfile(TrapezoidProfile& profile, float deltaTheta, float maxSpeed) {
+    if (!turnProfile || turnProfile->maxVelocity <= 0 || turnProfile->maxAcceleration <= 0) return false;
+    profile = TrapezoidProfile(turnProfile->maxVelocity * std::fabs(maxSpeed) / 127, turnProfile->maxAcceleration);
+    // the error goes to 0 as the robot turns
+    profile.reset(deltaTheta);
+    profile.setGoal(0);
+    return true;
+}
+
+float lemlib::Chassis::followTurnProfile(TrapezoidProfile& profile, float deltaTheta, float dt) {
+    profile.update(dt);
+    // turning clockwise makes the error smaller, so the robot turns at minus the error's velocity
+    const float velocity = -profile.getVelocity();
+    const float acceleration = -profile.getAcceleration();
+    const float friction = velocity > 0 ? turnProfile->kS : velocity < 0 ? -turnProfile->kS : 0;
+    const float feedforward = friction + turnProfile->kV * velocity + turnProfile->kA * acceleration;
+    // the PID corrects for the robot being ahead of or behind the profile
+    return feedforward + angularPID.update(deltaTheta - profile.getPosition(), dt);
+}
+
+double lemlib::Chassis::getForwardVelocity() { return getSensorSnapshot().forwardVelocity; }
+
+double lemlib::Chassis::getYawRate() { return getSensorSnapshot().yawRate; }
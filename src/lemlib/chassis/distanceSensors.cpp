@@ -0,0 +1,20 @@
+#include "lemlib/chassis/distanceSensors.hpp"
+
+lemlib::DistanceSensorRegistry::DistanceSensorRegistry(std::initializer_list<Entry> entries) {
+    for (const Entry& entry : entries) {
+        sensors[static_cast<int>(entry.side)] = entry.sensor;
+        mounts[static_cast<int>(entry.side)] = entry.mount;
+    }
+}
+
+pros::Distance* lemlib::DistanceSensorRegistry::getSensor(DistanceSide side) const {
+    return sensors[static_cast<int>(side)];
+}
+
+const lemlib::DistanceMount& lemlib::DistanceSensorRegistry::getMount(DistanceSide side) const {
+    return mounts[static_cast<int>(side)];
+}
+
+const std::array<lemlib::DistanceMount, lemlib::DISTANCE_SIDES>& lemlib::DistanceSensorRegistry::getMounts() const {
+    return mounts;
+}
@@ -0,0 +1,281 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "pros/rtos.hpp"
+#include "lemlib/chassis/globalLocalization.hpp"
+
+// poses whose costs are closer than this are tied, and the one nearest the hint wins
+constexpr float TIE_COST = 1;
+
+/**
+ * @brief A reading used to score poses
+ */
+struct Observation {
+        /** the sensor's mount */
+        const lemlib::DistanceMount* mount;
+        /** measured distance, in inches */
+        float measured;
+        /** standard deviation of the reading, in inches */
+        float noise;
+        /** false if the reading is past the sensor's range, so the sensor sees no wall */
+        bool seesWall;
+};
+
+/**
+ * @brief Where a sensor is and which way it points at one heading
+ */
+struct Beam {
+        float offsetX;
+        float offsetY;
+        /** the distance along the beam to each wall is (wall - sensor position) times these */
+        float inverseX;
+        float inverseY;
+        /** the x and y of the walls the beam faces */
+        float wallX;
+        float wallY;
+};
+
+/**
+ * @brief A scored pose
+ */
+struct Candidate {
+        float x;
+        float y;
+        float theta;
+        float cost;
+};
+
+/**
+ * @brief Work out where a sensor is and which way it points at a heading
+ *
+ * @param mount the sensor's mount
+ * @param theta the heading of the robot, in radians
+ * @param wall distance from the center of the field to each wall, in inches
+ * @return Beam
+ */
+static Beam makeBeam(const lemlib::DistanceMount& mount, float theta, float wall) {
+    const float sinTheta = std::sin(theta);
+    const float cosTheta = std::cos(theta);
+    const float beamX = std::sin(theta + mount.angle);
+    const float beamY = std::cos(theta + mount.angle);
+    Beam beam;
+    beam.offsetX = mount.x * cosTheta + mount.y * sinTheta;
+    beam.offsetY = mount.y * cosTheta - mount.x * sinTheta;
+    beam.inverseX = std::fabs(beamX) > 1e-6 ? 1 / beamX : INFINITY;
+    beam.inverseY = std::fabs(beamY) > 1e-6 ? 1 / beamY : INFINITY;
+    beam.wallX = beamX > 0 ? wall : -wall;
+    beam.wallY = beamY > 0 ? wall : -wall;
+    return beam;
+}
+
+/**
+ * @brief Score a pose by how badly the distances expected there match the readings
+ *
+ * @param x x position of the pose, in inches
+ * @param y y position of the pose, in inches
+ * @param beams the beam of each observation at the pose's heading
+ * @param observations the observations
+ * @param outlier cap on each difference, in standard deviations
+ * @return float the sum of the squared differences, in standard deviations
+ */
+static float score(float x, float y, const Beam* beams, const std::vector<Observation>& observations, float outlier) {
+    const float cap = outlier * outlier;
+    float cost = 0;
+    for (size_t i = 0; i < observations.size(); i++) {
+        const Beam& beam = beams[i];
+        const Observation& obs = observations[i];
+        // the beam hits whichever of the two walls it faces is closer. A beam parallel to a wall gives infinity
+        const float expectedX = (beam.wallX - x - beam.offsetX) * beam.inverseX;
+        const float expectedY = (beam.wallY - y - beam.offsetY) * beam.inverseY;
+        const float expected = std::fmin(std::fabs(expectedX), std::fabs(expectedY));
+        if (obs.seesWall) {
+            const float error = (obs.measured - expected) / obs.noise;
+            cost += std::fmin(error * error, cap);
+        } else if (expected + outlier * obs.noise < obs.mount->maxRange) {
+            // a wall should be in range, but the sensor didn't see one
+            cost += cap;
+        }
+    }
+    return cost;
+}
+
+/**
+ * @brief Score how far a heading is from the heading of the hint
+ *
+ * @param difference the difference between the headings, in radians
+ * @param noise the standard deviation of the difference, in radians
+ * @return float the squared difference, in standard deviations
+ */
+static float headingCost(float difference, float noise) {
+    const float error = difference / noise;
+    return error * error;
+}
+
+/**
+ * @brief Score a pose at any heading
+ *
+ * @param candidate the pose. Its cost is set
+ * @param observations the observations
+ * @param settings the global localization settings
+ * @param beams scratch space for one beam per observation
+ * @param hintTheta the heading of the hint, in radians
+ */
+static void scoreCandidate(Candidate& candidate, const std::vector<Observation>& observations,
+                           const lemlib::GlobalLocalizationSettings& settings, std::vector<Beam>& beams,
+                           float hintTheta) {
+    for (size_t i = 0; i < observations.size(); i++)
+        beams[i] = makeBeam(*observations[i].mount, candidate.theta, settings.fieldHalfSize);
+    candidate.cost = score(candidate.x, candidate.y, beams.data(), observations, settings.outlier) +
+                     headingCost(candidate.theta - hintTheta, settings.headingNoise);
+}
+
+/**
+ * @brief Check whether two poses are clearly different
+ *
+ * @param a the first pose
+ * @param b the second pose
+ * @return true if they are more than 3 inches or 0.1 radians apart
+ */
+static bool distinct(const Candidate& a, const Candidate& b) {
+    return std::hypot(a.x - b.x, a.y - b.y) > 3 || std::fabs(a.theta - b.theta) > 0.1;
+}
+
+std::array<lemlib::DistanceReading, lemlib::DISTANCE_SIDES> lemlib::medianDistances(const SensorSnapshot* snapshots,
+                                                                                   int count) {
+    std::array<DistanceReading, DISTANCE_SIDES> medians {};
+    std::vector<DistanceReading> valid;
+    for (int side = 0; side < DISTANCE_SIDES; side++) {
+        valid.clear();
+        for (int i = 0; i < count; i++) {
+            if (snapshots[i].distances[side].valid) valid.push_back(snapshots[i].distances[side]);
+        }
+        if (valid.empty() || static_cast<int>(valid.size()) * 2 < count) continue;
+        std::nth_element(valid.begin(), valid.begin() + valid.size() / 2, valid.end(),
+                         [](const DistanceReading& a, const DistanceReading& b) { return a.distance < b.distance; });
+        medians[side] = valid[valid.size() / 2];
+    }
+    return medians;
+}
+
+lemlib::GlobalLocalization lemlib::localizeGlobally(const DistanceReading* readings, const DistanceMount* mounts,
+                                                    int count, const Pose& hint,
+                                                    const GlobalLocalizationSettings& settings) {
+    const uint64_t start = pros::micros();
+    GlobalLocalization result;
+
+    // choose the readings to use
+    std::vector<Observation> observations;
+    int seesWall = 0;
+    for (int i = 0; i < count; i++) {
+        const DistanceReading& reading = readings[i];
+        if (!reading.valid || reading.confidence < settings.minConfidence) continue;
+        const float measured = reading.distance / 25.4;
+        const DistanceMount& mount = mounts[i];
+        const bool inRange = measured <= mount.maxRange;
+        observations.push_back(
+            {&mount, measured, std::fmax(mount.minNoise, mount.rangeNoise * measured), inRange});
+        seesWall += inRange;
+    }
+    result.used = observations.size();
+    // one distance can't pin down a position on a plane
+    if (seesWall < 2) return result;
+
+    // the beam of every observation at every heading searched, so scoring a pose doesn't need any trigonometry
+    const int headings =
+        std::max(1, static_cast<int>(std::ceil(2 * settings.headingWindow / settings.coarseHeadingStep)));
+    const float headingStep = headings > 1 ? 2 * settings.headingWindow / (headings - 1) : 0;
+    const float firstHeading = hint.theta - (headings > 1 ? settings.headingWindow : 0);
+    std::vector<Beam> table(headings * observations.size());
+    for (int h = 0; h < headings; h++) {
+        for (size_t i = 0; i < observations.size(); i++) {
+            table[h * observations.size() + i] =
+                makeBeam(*observations[i].mount, firstHeading + h * headingStep, settings.fieldHalfSize);
+        }
+    }
+
+    // coarse search over every pose on the grid, keeping the best few that aren't next to each other
+    const float limit = settings.fieldHalfSize - settings.wallClearance;
+    const int steps = std::max(1, static_cast<int>(2 * limit / settings.coarseStep) + 1);
+    const float step = steps > 1 ? 2 * limit / (steps - 1) : 0;
+    std::vector<Candidate> best;
+    best.reserve(settings.candidates + 1);
+    for (int h = 0; h < headings; h++) {
+        const Beam* beams = &table[h * observations.size()];
+        const float prior = headingCost(firstHeading + h * headingStep - hint.theta, settings.headingNoise);
+        for (int ix = 0; ix < steps; ix++) {
+            for (int iy = 0; iy < steps; iy++) {
+                const float x = -limit + ix * step;
+                const float y = -limit + iy * step;
+                const Candidate candidate = {x, y, firstHeading + h * headingStep,
+                                             score(x, y, beams, observations, settings.outlier) + prior};
+                result.evaluated++;
+                if (static_cast<int>(best.size()) == settings.candidates && candidate.cost >= best.back().cost)
+                    continue;
+                // a neighbour of a pose already kept replaces it if better, so the candidates cover different minima
+                auto neighbour = std::find_if(best.begin(), best.end(), [&](const Candidate& other) {
+                    return std::fabs(other.x - candidate.x) <= 2 * step &&
+                           std::fabs(other.y - candidate.y) <= 2 * step &&
+                           std::fabs(other.theta - candidate.theta) <= 2 * headingStep;
+                });
+                if (neighbour != best.end()) {
+                    if (candidate.cost >= neighbour->cost) continue;
+                    best.erase(neighbour);
+                }
+                best.insert(std::upper_bound(best.begin(), best.end(), candidate,
+                                             [](const Candidate& a, const Candidate& b) { return a.cost < b.cost; }),
+                            candidate);
+                if (static_cast<int>(best.size()) > settings.candidates) best.pop_back();
+            }
+        }
+    }
+
+    // refine each candidate with a pattern search, halving the step whenever no move improves it
+    std::vector<Beam> beams(observations.size());
+    for (Candidate& candidate : best) {
+        float moveStep = step / 2;
+        float turnStep = headingStep / 2;
+        while (moveStep >= settings.fineStep) {
+            bool improved = false;
+            const Candidate moves[6] = {{moveStep, 0, 0, 0},  {-moveStep, 0, 0, 0}, {0, moveStep, 0, 0},
+                                        {0, -moveStep, 0, 0}, {0, 0, turnStep, 0},  {0, 0, -turnStep, 0}};
+            for (const Candidate& move : moves) {
+                // stay inside the same bounds as the coarse grid
+                Candidate moved = {std::clamp(candidate.x + move.x, -limit, limit),
+                                   std::clamp(candidate.y + move.y, -limit, limit), candidate.theta + move.theta, 0};
+                if (moved.x == candidate.x && moved.y == candidate.y && moved.theta == candidate.theta) continue;
+                scoreCandidate(moved, observations, settings, beams, hint.theta);
+                result.evaluated++;
+                if (moved.cost < candidate.cost) {
+                    candidate = moved;
+                    improved = true;
+                }
+            }
+            if (!improved) {
+                moveStep /= 2;
+                turnStep /= 2;
+            }
+        }
+    }
+    std::sort(best.begin(), best.end(), [](const Candidate& a, const Candidate& b) { return a.cost < b.cost; });
+
+    // of the poses that explain the readings about as well as the best, take the one nearest the hint
+    auto chosen = best.begin();
+    for (auto it = best.begin(); it != best.end() && it->cost <= best.front().cost + TIE_COST; it++) {
+        if (std::hypot(it->x - hint.x, it->y - hint.y) < std::hypot(chosen->x - hint.x, chosen->y - hint.y))
+            chosen = it;
+    }
+    result.found = true;
+    result.pose = Pose(chosen->x, chosen->y, chosen->theta);
+    const float sensorCost = chosen->cost - headingCost(chosen->theta - hint.theta, settings.headingNoise);
+    result.error = std::sqrt(std::fmax(sensorCost, 0) / observations.size());
+    // the best pose that is clearly somewhere else
+    result.gap = INFINITY;
+    for (const Candidate& other : best) {
+        if (!distinct(other, *chosen)) continue;
+        result.alternative = Pose(other.x, other.y, other.theta);
+        result.gap = other.cost - chosen->cost;
+        break;
+    }
+    result.time = pros::micros() - start;
+    return result;
+}
@@ -0,0 +1,58 @@
+#include <cmath>
+#include "lemlib/chassis/headingFilter.hpp"
+
+lemlib::HeadingFilter::HeadingFilter(HeadingFilterSettings settings)
+    : settings(settings) {
+    reset();
+}
+
+float lemlib::HeadingFilter::update(float dt, bool hasImu, float deltaImu, bool hasWheels, float deltaWheels,
+                                    bool driven) {
+    // the wheels scrub more the faster the robot turns
+    const float scrub = (driven ? settings.drivetrainScrub : settings.trackingWheelScrub) * std::fabs(deltaWheels);
+    const float wheelVariance = settings.trackingWheelNoise * settings.trackingWheelNoise + scrub * scrub;
+
+    // with only one source there is nothing to fuse, and the IMU drift can't be observed
+    if (!hasImu) {
+        if (!hasWheels) return 0;
+        variance += wheelVariance;
+        return deltaWheels;
+    }
+
+    // predict the change in heading using the IMU, corrected for its drift
+    pBias += settings.imuBiasNoise * settings.imuBiasNoise * dt;
+    float deltaHeading = deltaImu - bias * dt;
+    float pHeading = settings.imuNoise * settings.imuNoise * dt + dt * dt * pBias;
+    const float pCross = -dt * pBias;
+    if (!hasWheels) {
+        variance += pHeading;
+        return deltaHeading;
+    }
+
+    // correct it using the tracking wheels
+    const float innovation = deltaWheels - deltaHeading;
+    const float innovationVariance = pHeading + wheelVariance;
+    const float headingGain = pHeading / innovationVariance;
+    const float biasGain = pCross / innovationVariance;
+    deltaHeading += headingGain * innovation;
+    bias += biasGain * innovation;
+    pHeading -= headingGain * pHeading;
+    pBias -= biasGain * pCross;
+    variance += pHeading;
+    return deltaHeading;
+}
+
+float lemlib::HeadingFilter::getImuBias() const { return bias; }
+
+float lemlib::HeadingFilter::getUncertainty() const { return std::sqrt(variance); }
+
+void lemlib::HeadingFilter::setSettings(HeadingFilterSettings settings) {
+    this->settings = settings;
+    reset();
+}
+
+void lemlib::HeadingFilter::reset() {
+    bias = 0;
+    pBias = settings.imuBiasInitial * settings.imuBiasInitial;
+    variance = 0;
+}
@@ -0,0 +1,174 @@
+#include <cmath>
+#include "lemlib/chassis/localization.hpp"
+
+lemlib::ParticleFilterSettings particleFilterSettings; // particle filter tuning used by odometry
+
+void lemlib::setParticleFilterSettings(const ParticleFilterSettings& settings) { particleFilterSettings = settings; }
+
+const lemlib::ParticleFilterSettings& lemlib::getParticleFilterSettings() { return particleFilterSettings; }
+
+const Map& lemlib::getFieldMap() {
+    // Static constant instance of the map with updated boundaries
+    static const Map map = [] {
+        Map m;
+
+        // Define the field boundaries for x and y (from -72 to 72)
+        m.min_x = -72;
+        m.max_x = 72;
+        m.min_y = -72;
+        m.max_y = 72;
+
+        // Define the obstacles (landmarks)
+        m.landmark_list = {
+            {1, 24.0, 0.0}, // Obstacle at (24, 0)
+            {2, 0.0, 24.0}, // Obstacle at (0, 24)
+            {3, -24.0, 0.0}, // Obstacle at (-24, 0)
+            {4, 0.0, -24.0} // Obstacle at (0, -24)
+        };
+
+        return m;
+    }();
+    return map;
+}
+
+std::vector<LandmarkObs> lemlib::buildObservations(const SensorSnapshot& snapshot, const DistanceMount* mounts,
+                                                   const Pose& localDelta, const ParticleFilterSettings& settings,
+                                                   std::default_random_engine& gen) {
+    std::vector<LandmarkObs> observations;
+    std::normal_distribution<double> N_obs_x(localDelta.x, settings.landmarkNoise[0]);
+    std::normal_distribution<double> N_obs_y(localDelta.y, settings.landmarkNoise[1]);
+
+    for (int i = 0; i < DISTANCE_SIDES; i++) {
+        const DistanceReading& reading = snapshot.distances[i];
+        if (!reading.valid) continue;
+        // Convert the reading from mm to inches and project it along the beam from the sensor mount.
+        const DistanceMount& mount = mounts[i];
+        const double measured = reading.distance / 25.4;
+        LandmarkObs obs {static_cast<int>(observations.size() + 1), N_obs_x(gen), N_obs_y(gen)};
+        obs.x += mount.x + measured * std::sin(mount.angle);
+        obs.y += mount.y + measured * std::cos(mount.angle);
+        observations.push_back(obs);
+    }
+    return observations;
+}
+
+/**
+ * @brief Convert a heading between LemLib's convention and the particle filter's
+ *
+ * LemLib headings are 0 along +y and increase clockwise. The particle filter uses the usual maths convention, 0 along
+ * +x and increasing anticlockwise, with the robot's x axis pointing forwards. The conversion is its own inverse.
+ *
+ * @param theta the heading, in radians
+ * @return double the heading in the other convention
+ */
+static double convertHeading(double theta) { return M_PI / 2 - theta; }
+
+void lemlib::seedParticleFilter(ParticleFilter& pf, const ParticleFilterSettings& settings, const Pose& pose,
+                                std::default_random_engine& gen) {
+    // ParticleFilter::init takes the noise as a mutable array
+    std::array<double, 3> initialNoise = settings.initialNoise;
+    std::normal_distribution<double> N_x_init(pose.x, initialNoise[0]);
+    std::normal_distribution<double> N_y_init(pose.y, initialNoise[1]);
+    std::normal_distribution<double> N_theta_init(convertHeading(pose.theta), initialNoise[2]);
+    pf.init(N_x_init(gen), N_y_init(gen), N_theta_init(gen), initialNoise.data(), settings.particles);
+}
+
+/**
+ * @brief A distance sensor reading to weigh the particles with
+ */
+struct Range {
+        /** the sensor */
+        lemlib::DistanceSide side;
+        /** measured distance, in inches */
+        float measured;
+        /** one over the standard deviation of the reading, in inches */
+        float inverseNoise;
+        /** the sensor's range, in inches */
+        float maxRange;
+};
+
+/**
+ * @brief Move the particles by the motion measured by odometry, and copy the augmented MCL settings to the filter
+ *
+ * @param pf the particle filter
+ * @param settings the particle filter settings
+ * @param dt time since the last step, in seconds
+ * @param localSpeed speed of the robot in the robot frame, in inches and radians per second
+ */
+static void predictParticles(ParticleFilter& pf, const lemlib::ParticleFilterSettings& settings, double dt,
+                             const lemlib::Pose& localSpeed) {
+    std::array<double, 3> motionNoise = settings.motionNoise;
+    // signed by the forward speed, so the particles move backwards when the robot does
+    const double speed = std::copysign(std::hypot(localSpeed.x, localSpeed.y), localSpeed.y);
+    pf.alpha_slow = settings.slowAverageRate;
+    pf.alpha_fast = settings.fastAverageRate;
+    pf.injection_threshold = settings.injectionThreshold;
+    pf.max_injection = settings.maxInjection;
+    // the filter turns anticlockwise, and its robot frame has x forwards and y to the left
+    pf.prediction(dt, motionNoise.data(), speed, -localSpeed.theta);
+}
+
+void lemlib::stepParticleFilter(ParticleFilter& pf, const ParticleFilterSettings& settings, double dt,
+                                const Pose& localSpeed, const std::vector<LandmarkObs>& observations, const Map& map) {
+    std::array<double, 2> landmarkNoise = settings.landmarkNoise;
+    predictParticles(pf, settings, dt, localSpeed);
+    std::vector<LandmarkObs> filterObservations = observations;
+    for (LandmarkObs& obs : filterObservations) obs = {obs.id, obs.y, -obs.x};
+    pf.updateWeights(settings.sensorRange, landmarkNoise.data(), filterObservations, map);
+    pf.resample();
+}
+
+void lemlib::stepParticleFilter(ParticleFilter& pf, const ParticleFilterSettings& settings, double dt,
+                                const Pose& localSpeed, const SensorSnapshot& snapshot, const RangeTable& table,
+                                const Map& map) {
+    std::array<Range, DISTANCE_SIDES> ranges;
+    int count = 0;
+    for (int i = 0; i < DISTANCE_SIDES; i++) {
+        const DistanceSide side = static_cast<DistanceSide>(i);
+        const DistanceReading& reading = snapshot.distances[i];
+        if (!reading.valid || !table.hasSensor(side)) continue;
+        const DistanceMount& mount = table.getMount(side);
+        const float measured = reading.distance / 25.4;
+        if (measured > mount.maxRange) continue;
+        ranges[count++] = {side, measured, 1 / std::fmax(mount.minNoise, mount.rangeNoise * measured), mount.maxRange};
+    }
+
+    predictParticles(pf, settings, dt, localSpeed);
+    // the likelihood of a reading never drops below that of an outlier, so one blocked sensor can't rule out the
+    // right particles
+    const double outlier = std::exp(-0.5 * settings.rangeOutlier * settings.rangeOutlier);
+    pf.updateWeights(
+        [&](const Particle& particle) {
+            const float heading = convertHeading(particle.theta);
+            double likelihood = 1;
+            for (int i = 0; i < count; i++) {
+                const Range& range = ranges[i];
+                // the wall is at least the sensor's range away if the table has it out of range
+                const float expected =
+                    std::fmin(table.getExpected(range.side, particle.x, particle.y, heading), range.maxRange);
+                const float error = (range.measured - expected) * range.inverseNoise;
+                likelihood *= std::fmax(std::exp(-0.5 * error * error), outlier);
+            }
+            return likelihood;
+        },
+        count, map);
+    pf.resample();
+}
+
+lemlib::Pose lemlib::getParticleMean(const ParticleFilter& pf, const Pose& fallback) {
+    double sum_x = 0.0, sum_y = 0.0, sum_sin = 0.0, sum_cos = 0.0, sum_weight = 0.0;
+    for (const Particle& p : pf.particles) {
+        sum_x += p.x * p.weight;
+        sum_y += p.y * p.weight;
+        // average the headings as unit vectors, so particles either side of the wrap around don't cancel out
+        sum_sin += std::sin(p.theta) * p.weight;
+        sum_cos += std::cos(p.theta) * p.weight;
+        sum_weight += p.weight;
+    }
+    // avoid dividing by zero
+    if (std::fabs(sum_weight) < 1e-9) return fallback;
+    double theta = convertHeading(std::atan2(sum_sin, sum_cos));
+    // odometry headings aren't wrapped, so give the one closest to the fallback's
+    if (std::isfinite(fallback.theta)) theta += 2 * M_PI * std::round((fallback.theta - theta) / (2 * M_PI));
+    return Pose(sum_x / sum_weight, sum_y / sum_weight, theta);
+}
@@ -2,6 +2,7 @@
 #include "lemlib/chassis/chassis.hpp"
 #include "lemlib/logger/logger.hpp"
 #include "lemlib/timer.hpp"
+#include "lemlib/periodicTask.hpp"
 #include "lemlib/util.hpp"
 #include "pros/misc.hpp"
 
@@ -39,6 +40,8 @@ void lemlib::Chassis::moveForward(float dist, int timeout, MoveToPointParams par
     Pose lastPose = getPose();
     distTraveled = 0;
     Timer timer(timeout);
+    Rate rate(10);
+    float dt = PID::NOMINAL_PERIOD; // time the last iteration took, which the PIDs integrate over
     float prevLateralOut = 0;
     bool close = false;
     float initTheta = getPose(true, true).theta;
@@ -61,6 +64,7 @@ void lemlib::Chassis::moveForward(float dist, int timeout, MoveToPointParams par
 
     // Heading PID to maintain straight line
     lemlib::PID headingPID(2.0, 0.0, 12.0); // tune for your chassis
+    headingPID.setOutputLimits(-20, 20);
 
     // Main loop
     while (!timer.isDone() && ((!lateralSmallExit.getExit() && !lateralLargeExit.getExit()) || !close) &&
@@ -85,11 +89,10 @@ void lemlib::Chassis::moveForward(float dist, int timeout, MoveToPointParams par
         lateralSmallExit.update(lateralError);
         lateralLargeExit.update(lateralError);
 
+        // maxSpeed drops once close, so the limits are set every iteration
+        lateralPID.setOutputLimits(-params.maxSpeed, params.maxSpeed);
         // Lateral PID output
-        float lateralOut = lateralPID.update(lateralError);
-
-        // Clamp output to maxSpeed
-        lateralOut = std::clamp(lateralOut, -params.maxSpeed, params.maxSpeed);
+        float lateralOut = lateralPID.update(lateralError, dt);
 
         // Apply slew rate limiting for smooth acceleration/deceleration
         lateralOut = slew(lateralOut, prevLateralOut, lateralSettings.slew);
@@ -109,8 +112,7 @@ void lemlib::Chassis::moveForward(float dist, int timeout, MoveToPointParams par
         // Heading correction
         float currentTheta = getPose(true, true).theta;
         float headingError = lemlib::wrapAngle(initTheta - currentTheta);
-        float headingOut = headingPID.update(headingError);
-        headingOut = std::clamp(headingOut, -20.0f, 20.0f);
+        float headingOut = headingPID.update(headingError, dt);
 
         if (close) headingOut = 0;  // disable heading correction near target
 
@@ -129,7 +131,7 @@ void lemlib::Chassis::moveForward(float dist, int timeout, MoveToPointParams par
         drivetrain.leftMotors->move(leftPower);
         drivetrain.rightMotors->move(rightPower);
 
-        pros::delay(10);
+        dt = rate.delay();
     }
 
     // Stop drivetrain (COAST mode remains)
@@ -2,6 +2,7 @@
 #include "lemlib/chassis/chassis.hpp"
 #include "lemlib/logger/logger.hpp"
 #include "lemlib/timer.hpp"
+#include "lemlib/periodicTask.hpp"
 #include "lemlib/util.hpp"
 #include "pros/misc.hpp"
 
@@ -28,6 +29,8 @@ void lemlib::Chassis::moveToPoint(float x, float y, int timeout, MoveToPointPara
     Pose lastPose = getPose();
     distTraveled = 0;
     Timer timer(timeout);
+    Rate rate(10);
+    float dt = PID::NOMINAL_PERIOD; // time the last iteration took, which the PIDs integrate over
     bool close = false;
     float prevLateralOut = 0; // previous lateral power
     float prevAngularOut = 0; // previous angular power
@@ -75,17 +78,17 @@ void lemlib::Chassis::moveToPoint(float x, float y, int timeout, MoveToPointPara
         lateralSmallExit.update(lateralError);
         lateralLargeExit.update(lateralError);
 
+        // maxSpeed drops once close, so the limits are set every iteration
+        lateralPID.setOutputLimits(-params.maxSpeed, params.maxSpeed);
+        angularPID.setOutputLimits(-params.maxSpeed, params.maxSpeed);
         // get output from PIDs
-        float lateralOut = lateralPID.update(lateralError);
-        float angularOut = angularPID.update(radToDeg(angularError));
+        float lateralOut = lateralPID.update(lateralError, dt);
+        float angularOut = angularPID.update(radToDeg(angularError), dt);
         if (close) angularOut = 0;
 
         // apply restrictions on angular speed
-        angularOut = std::clamp(angularOut, -params.maxSpeed, params.maxSpeed);
         angularOut = slew(angularOut, prevAngularOut, angularSettings.slew);
 
-        // apply restrictions on lateral speed
-        lateralOut = std::clamp(lateralOut, -params.maxSpeed, params.maxSpeed);
         // constrain lateral output by max accel
         // but not for decelerating, since that would interfere with settling
         if (!close) lateralOut = slew(lateralOut, prevLateralOut, lateralSettings.slew);
@@ -118,8 +121,8 @@ void lemlib::Chassis::moveToPoint(float x, float y, int timeout, MoveToPointPara
         drivetrain.leftMotors->move(leftPower);
         drivetrain.rightMotors->move(rightPower);
 
-        // delay to save resources
-        pros::delay(10);
+        // wait for the next control period
+        dt = rate.delay();
     }
 
     // stop the drivetrain
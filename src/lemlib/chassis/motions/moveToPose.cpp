@@ -2,6 +2,7 @@
 #include "lemlib/chassis/chassis.hpp"
 #include "lemlib/logger/logger.hpp"
 #include "lemlib/timer.hpp"
+#include "lemlib/periodicTask.hpp"
 #include "lemlib/util.hpp"
 #include "pros/misc.hpp"
 
@@ -37,6 +38,8 @@ void lemlib::Chassis::moveToPose(float x, float y, float theta, int timeout, Mov
     Pose lastPose = getPose();
     distTraveled = 0;
     Timer timer(timeout);
+    Rate rate(10);
+    float dt = PID::NOMINAL_PERIOD; // time the last iteration took, which the PIDs integrate over
     bool close = false;
     bool lateralSettled = false;
     bool prevSameSide = false;
@@ -98,15 +101,12 @@ void lemlib::Chassis::moveToPose(float x, float y, float theta, int timeout, Mov
         angularSmallExit.update(radToDeg(angularError));
         angularLargeExit.update(radToDeg(angularError));
 
+        // maxSpeed drops once close, so the limits are set every iteration
+        lateralPID.setOutputLimits(-params.maxSpeed, params.maxSpeed);
+        angularPID.setOutputLimits(-params.maxSpeed, params.maxSpeed);
         // get output from PIDs
-        float lateralOut = lateralPID.update(lateralError);
-        float angularOut = angularPID.update(radToDeg(angularError));
-
-        // apply restrictions on angular speed
-        angularOut = std::clamp(angularOut, -params.maxSpeed, params.maxSpeed);
-
-        // apply restrictions on lateral speed
-        lateralOut = std::clamp(lateralOut, -params.maxSpeed, params.maxSpeed);
+        float lateralOut = lateralPID.update(lateralError, dt);
+        float angularOut = angularPID.update(radToDeg(angularError), dt);
 
         // constrain lateral output by max accel
         if (!close) lateralOut = slew(lateralOut, prevLateralOut, lateralSettings.slew);
@@ -148,8 +148,8 @@ void lemlib::Chassis::moveToPose(float x, float y, float theta, int timeout, Mov
         drivetrain.leftMotors->move(leftPower);
         drivetrain.rightMotors->move(rightPower);
 
-        // delay to save resources
-        pros::delay(10);
+        // wait for the next control period
+        dt = rate.delay();
     }
 
     // stop the drivetrain
@@ -10,175 +10,8 @@
 #include "lemlib/logger/logger.hpp"
 #include "lemlib/chassis/chassis.hpp"
 #include "lemlib/util.hpp"
-
-/**
- * @brief function that returns elements in a file line, separated by a delimeter
- *
- * @param input the raw string
- * @param delimeter string separating the elements in the line
- * @return std::vector<std::string> array of elements read from the file
- */
-std::vector<std::string> readElement(const std::string& input, const std::string& delimiter) {
-    std::string token;
-    std::string s = input;
-    std::vector<std::string> output;
-    size_t pos = 0;
-
-    // main loop
-    while ((pos = s.find(delimiter)) != std::string::npos) { // while there are still delimiters in the string
-        token = s.substr(0, pos); // processed substring
-        output.push_back(token);
-        s.erase(0, pos + delimiter.length()); // remove the read substring
-    }
-
-    output.push_back(s); // add the last element to the returned string
-
-    return output;
-}
-
-/**
- * @brief Convert a string to hex
- *
- * @param input the string to convert
- * @return std::string hexadecimal output
- */
-std::string stringToHex(const std::string& input) {
-    static const char hex_digits[] = "0123456789ABCDEF";
-
-    std::string output;
-    output.reserve(input.length() * 2);
-    for (unsigned char c : input) {
-        output.push_back(hex_digits[c >> 4]);
-        output.push_back(hex_digits[c & 15]);
-    }
-    return output;
-}
-
-/**
- * @brief Get a path from the sd card
- *
- * @param filePath The file to read from
- * @return std::vector<lemlib::Pose> vector of points on the path
- */
-std::vector<lemlib::Pose> getData(const asset& path) {
-    std::vector<lemlib::Pose> robotPath;
-
-    // format data from the asset
-    const std::string data(reinterpret_cast<char*>(path.buf), path.size);
-    const std::vector<std::string> dataLines = readElement(data, "\n");
-
-    // read the points until 'endData' is read
-    for (std::string line : dataLines) {
-        lemlib::infoSink()->debug("read raw line {}", stringToHex(line));
-        if (line == "endData" || line == "endData\r") break;
-        const std::vector<std::string> pointInput = readElement(line, ", "); // parse line
-        // check if the line was read correctly
-        if (pointInput.size() != 3) {
-            lemlib::infoSink()->error("Failed to read path file! Are you using the right format? Raw line: {}",
-                                      stringToHex(line));
-            break;
-        }
-        lemlib::Pose pathPoint(0, 0);
-        pathPoint.x = std::stof(pointInput.at(0)); // x position
-        pathPoint.y = std::stof(pointInput.at(1)); // y position
-        pathPoint.theta = std::stof(pointInput.at(2)); // velocity
-        robotPath.push_back(pathPoint); // save data
-        lemlib::infoSink()->debug("read point {}", pathPoint);
-    }
-
-    return robotPath;
-}
-
-/**
- * @brief find the closest point on the path to the robot
- *
- * @param pose the current pose of the robot
- * @param path the path to follow
- * @return int index to the closest point
- */
-int findClosest(lemlib::Pose pose, std::vector<lemlib::Pose> path) {
-    int closestPoint;
-    float closestDist = infinity();
-
-    // loop through all path points
-    for (int i = 0; i < path.size(); i++) {
-        const float dist = pose.distance(path.at(i));
-        if (dist < closestDist) { // new closest point
-            closestDist = dist;
-            closestPoint = i;
-        }
-    }
-
-    return closestPoint;
-}
-
-/**
- * @brief Function that finds the intersection point between a circle and a line
- *
- * @param p1 start point of the line
- * @param p2 end point of the line
- * @param pos position of the robot
- * @param path the path to follow
- * @return float how far along the line the
- */
-float circleIntersect(lemlib::Pose p1, lemlib::Pose p2, lemlib::Pose pose, float lookaheadDist) {
-    // calculations
-    // uses the quadratic formula to calculate intersection points
-    lemlib::Pose d = p2 - p1;
-    lemlib::Pose f = p1 - pose;
-    float a = d * d;
-    float b = 2 * (f * d);
-    float c = (f * f) - lookaheadDist * lookaheadDist;
-    float discriminant = b * b - 4 * a * c;
-
-    // if a possible intersection was found
-    if (discriminant >= 0) {
-        discriminant = sqrt(discriminant);
-        float t1 = (-b - discriminant) / (2 * a);
-        float t2 = (-b + discriminant) / (2 * a);
-
-        // prioritize further down the path
-        if (t2 >= 0 && t2 <= 1) return t2;
-        else if (t1 >= 0 && t1 <= 1) return t1;
-    }
-
-    // no intersection found
-    return -1;
-}
-
-/**
- * @brief returns the lookahead point
- *
- * @param lastLookahead - the last lookahead point
- * @param pose - the current position of the robot
- * @param path - the path to follow
- * @param closest - the index of the point closest to the robot
- * @param lookaheadDist - the lookahead distance of the algorithm
- */
-lemlib::Pose lookaheadPoint(lemlib::Pose lastLookahead, lemlib::Pose pose, std::vector<lemlib::Pose> path, int closest,
-                            float lookaheadDist) {
-    // optimizations applied:
-    // only consider intersections that have an index greater than or equal to the point closest
-    // to the robot
-    // and intersections that have an index greater than or equal to the index of the last
-    // lookahead point
-    const int start = std::max(closest, int(lastLookahead.theta));
-    for (int i = start; i < path.size() - 1; i++) {
-        lemlib::Pose lastPathPose = path.at(i);
-        lemlib::Pose currentPathPose = path.at(i + 1);
-
-        float t = circleIntersect(lastPathPose, currentPathPose, pose, lookaheadDist);
-
-        if (t != -1) {
-            lemlib::Pose lookahead = lastPathPose.lerp(currentPathPose, t);
-            lookahead.theta = i;
-            return lookahead;
-        }
-    }
-
-    // robot deviated from path, use last lookahead point
-    return lastLookahead;
-}
+#include "lemlib/periodicTask.hpp"
+#include "lemlib/chassis/pursuitPath.hpp"
 
 /**
  * @brief Get the curvature of a circle that intersects the robot and the lookahead point
@@ -237,6 +70,7 @@ void lemlib::Chassis::follow(const asset& path, float lookahead, int timeout, bo
     float prevVel = 0;
     int compState = pros::competition::get_status();
     distTraveled = 0;
+    Rate rate(10); // fixed rate, so the iteration count below matches the timeout
 
     // loop until the robot is within the end tolerance
     for (int i = 0; i < timeout / 10 && pros::competition::get_status() == compState && this->motionRunning; i++) {
@@ -290,7 +124,7 @@ void lemlib::Chassis::follow(const asset& path, float lookahead, int timeout, bo
             drivetrain.rightMotors->move(-targetLeftVel);
         }
 
-        pros::delay(10);
+        rate.delay();
     }
 
     // stop the robot
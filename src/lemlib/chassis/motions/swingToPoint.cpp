@@ -2,6 +2,7 @@
 #include "lemlib/chassis/chassis.hpp"
 #include "lemlib/logger/logger.hpp"
 #include "lemlib/timer.hpp"
+#include "lemlib/periodicTask.hpp"
 #include "lemlib/util.hpp"
 #include "pros/misc.hpp"
 
@@ -29,9 +30,12 @@ void lemlib::Chassis::swingToPoint(float x, float y, DriveSide lockedSide, int t
     std::uint8_t compState = pros::competition::get_status();
     distTraveled = 0;
     Timer timer(timeout);
+    Rate rate(10);
+    float dt = PID::NOMINAL_PERIOD; // time the last iteration took, which the PIDs integrate over
     angularLargeExit.reset();
     angularSmallExit.reset();
     angularPID.reset();
+    angularPID.setOutputLimits(-params.maxSpeed, params.maxSpeed); // the integral stops growing at maxSpeed
     // get original braking mode of that side of the drivetrain so we can set it back to it after this motion ends
     pros::MotorBrake brakeMode = (lockedSide == DriveSide::LEFT)
                                      ? this->drivetrain.leftMotors->get_brake_mode_all().at(0)
@@ -68,14 +72,13 @@ void lemlib::Chassis::swingToPoint(float x, float y, DriveSide lockedSide, int t
         if (params.minSpeed != 0 && fabs(deltaTheta) < params.earlyExitRange) break;
         if (params.minSpeed != 0 && sgn(deltaTheta) != sgn(prevDeltaTheta)) break;
 
-        // calculate the speed
-        motorPower = angularPID.update(deltaTheta);
+        // calculate the speed, with the gains for how far there is left to turn and how fast the robot is turning
+        scheduleAngularGains(deltaTheta);
+        motorPower = angularPID.update(deltaTheta, dt);
         angularLargeExit.update(deltaTheta);
         angularSmallExit.update(deltaTheta);
 
-        // cap the speed
-        if (motorPower > params.maxSpeed) motorPower = params.maxSpeed;
-        else if (motorPower < -params.maxSpeed) motorPower = -params.maxSpeed;
+        // limit acceleration, and don't go slower than the minimum speed
         if (fabs(deltaTheta) > 20) motorPower = slew(motorPower, prevMotorPower, angularSettings.slew);
         if (motorPower < 0 && motorPower > -params.minSpeed) motorPower = -params.minSpeed;
         else if (motorPower > 0 && motorPower < params.minSpeed) motorPower = params.minSpeed;
@@ -92,7 +95,7 @@ void lemlib::Chassis::swingToPoint(float x, float y, DriveSide lockedSide, int t
             drivetrain.rightMotors->brake();
         }
 
-        pros::delay(10);
+        dt = rate.delay();
     }
 
     // set the brake mode of the locked side of the drivetrain to its
@@ -102,6 +105,8 @@ void lemlib::Chassis::swingToPoint(float x, float y, DriveSide lockedSide, int t
     // stop the drivetrain
     drivetrain.leftMotors->move(0);
     drivetrain.rightMotors->move(0);
+    // other motions use the angular gains from the controller settings
+    resetAngularGains();
     // set distTraveled to -1 to indicate that the function has finished
     distTraveled = -1;
     this->endMotion();
@@ -1,7 +1,9 @@
+#include <algorithm>
 #include <cmath>
 #include "lemlib/chassis/chassis.hpp"
 #include "lemlib/logger/logger.hpp"
 #include "lemlib/timer.hpp"
+#include "lemlib/periodicTask.hpp"
 #include "lemlib/util.hpp"
 #include "pros/misc.hpp"
 
@@ -28,9 +30,15 @@ void lemlib::Chassis::turnToHeading(float theta, int timeout, TurnToHeadingParam
     std::uint8_t compState = pros::competition::get_status();
     distTraveled = 0;
     Timer timer(timeout);
+    Rate rate(10);
+    float dt = PID::NOMINAL_PERIOD; // time the last iteration took, which the PIDs integrate over
+    // profiled turns follow the profile first, then the PID finishes the turn from where it ends
+    TrapezoidProfile profile(0, 0);
+    bool profiling = false;
     angularLargeExit.reset();
     angularSmallExit.reset();
     angularPID.reset();
+    angularPID.setOutputLimits(-params.maxSpeed, params.maxSpeed); // the integral stops growing at maxSpeed
 
     // main loop
     while (!timer.isDone() && !angularLargeExit.getExit() && !angularSmallExit.getExit() && this->motionRunning) {
@@ -51,21 +59,33 @@ void lemlib::Chassis::turnToHeading(float theta, int timeout, TurnToHeadingParam
         // calculate deltaTheta
         if (settling) deltaTheta = angleError(targetTheta, pose.theta, false);
         else deltaTheta = angleError(targetTheta, pose.theta, false, params.direction);
-        if (prevDeltaTheta == std::nullopt) prevDeltaTheta = deltaTheta;
+        if (prevDeltaTheta == std::nullopt) {
+            prevDeltaTheta = deltaTheta;
+            if (params.profiled) profiling = startTurnProfile(profile, deltaTheta, params.maxSpeed);
+        }
 
         // motion chaining
         if (params.minSpeed != 0 && fabs(deltaTheta) < params.earlyExitRange) break;
         if (params.minSpeed != 0 && sgn(deltaTheta) != sgn(prevDeltaTheta)) break;
 
-        // calculate the speed
-        motorPower = angularPID.update(deltaTheta);
+        if (profiling && !profile.isDone()) {
+            // the profile already limits acceleration
+            motorPower = std::clamp(followTurnProfile(profile, deltaTheta, dt), float(-params.maxSpeed),
+                                    float(params.maxSpeed));
+        } else {
+            // the PID starts again for the end of the turn, without the derivative of following the profile
+            if (profiling) angularPID.reset();
+            profiling = false;
+            // calculate the speed, with the gains for how far there is left to turn and how fast the robot is turning
+            scheduleAngularGains(deltaTheta);
+            motorPower = angularPID.update(deltaTheta, dt);
+            // limit acceleration
+            if (fabs(deltaTheta) > 20) motorPower = slew(motorPower, prevMotorPower, angularSettings.slew);
+        }
         angularLargeExit.update(deltaTheta);
         angularSmallExit.update(deltaTheta);
 
-        // cap the speed
-        if (motorPower > params.maxSpeed) motorPower = params.maxSpeed;
-        else if (motorPower < -params.maxSpeed) motorPower = -params.maxSpeed;
-        if (fabs(deltaTheta) > 20) motorPower = slew(motorPower, prevMotorPower, angularSettings.slew);
+        // don't go slower than the minimum speed
         if (motorPower < 0 && motorPower > -params.minSpeed) motorPower = -params.minSpeed;
         else if (motorPower > 0 && motorPower < params.minSpeed) motorPower = params.minSpeed;
         prevMotorPower = motorPower;
@@ -76,12 +96,14 @@ void lemlib::Chassis::turnToHeading(float theta, int timeout, TurnToHeadingParam
         drivetrain.leftMotors->move(motorPower);
         drivetrain.rightMotors->move(-motorPower);
 
-        pros::delay(10);
+        dt = rate.delay();
     }
 
     // stop the drivetrain
     drivetrain.leftMotors->move(0);
     drivetrain.rightMotors->move(0);
+    // other motions use the angular gains from the controller settings
+    resetAngularGains();
     // set distTraveled to -1 to indicate that the function has finished
     distTraveled = -1;
     this->endMotion();
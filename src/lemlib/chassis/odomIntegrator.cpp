@@ -0,0 +1,134 @@
+// The implementation below is mostly based off of
+// the document written by 5225A (Pilons)
+// Here is a link to the original document
+// http://thepilons.ca/wp-content/uploads/2018/10/Tracking.pdf
+
+#include <cmath>
+#include "lemlib/chassis/odomIntegrator.hpp"
+
+// time constant of the speed filter, in seconds. The same smoothing as the old 0.95 per 10ms
+constexpr float SPEED_FILTER_TIME = 0.0033;
+
+// same as lemlib::ema, which can't be used here because util.hpp depends on PROS
+static float smooth(float current, float previous, float factor) { return current * factor + previous * (1 - factor); }
+
+lemlib::OdomIntegrator::OdomIntegrator(OdomGeometry geometry, OdomIntegration integration)
+    : geometry(geometry),
+      integration(integration) {}
+
+void lemlib::OdomIntegrator::update(const SensorSnapshot& snapshot, float dt) {
+    // guard against a bad timestamp blowing up the speed estimates
+    if (dt <= 0) dt = 0.01;
+
+    // 1) Calculate the change in sensor values since the last update.
+    const float deltaVertical1 = snapshot.vertical1 - prev.vertical1;
+    const float deltaVertical2 = snapshot.vertical2 - prev.vertical2;
+    const float deltaHorizontal1 = snapshot.horizontal1 - prev.horizontal1;
+    const float deltaHorizontal2 = snapshot.horizontal2 - prev.horizontal2;
+    // if the IMU didn't give a reading, keep the last one so the next reading covers the gap
+    const float imu = snapshot.imuValid ? snapshot.imuRotation : prev.imuRotation;
+    const float deltaImu = imu - prev.imuRotation;
+    prev = snapshot;
+    prev.imuRotation = imu;
+
+    // 2) Compute heading by fusing the IMU with a pair of tracking wheels.
+    // The horizontal pair is preferred over the vertical pair, since the vertical pair may be substituted by the
+    // drivetrain. The filter weighs each source by its noise model and estimates the IMU drift.
+    bool hasWheels = false;
+    bool wheelsDriven = false;
+    float deltaWheels = 0;
+    if (geometry.horizontal1.present && geometry.horizontal2.present) {
+        hasWheels = true;
+        wheelsDriven = geometry.horizontal1.driven || geometry.horizontal2.driven;
+        deltaWheels =
+            -(deltaHorizontal1 - deltaHorizontal2) / (geometry.horizontal1.offset - geometry.horizontal2.offset);
+    } else if (geometry.vertical1.present && geometry.vertical2.present) {
+        hasWheels = true;
+        wheelsDriven = geometry.vertical1.driven || geometry.vertical2.driven;
+        deltaWheels = -(deltaVertical1 - deltaVertical2) / (geometry.vertical1.offset - geometry.vertical2.offset);
+    }
+    const float deltaHeading =
+        headingFilter.update(dt, snapshot.imuValid, deltaImu, hasWheels, deltaWheels, wheelsDriven);
+    const float avgHeading = pose.theta + deltaHeading / 2;
+
+    // 3) Choose tracking wheels to use. Prioritize non-powered tracking wheels
+    float deltaX = 0;
+    float deltaY = 0;
+    float horizontalOffset = 0;
+    float verticalOffset = 0;
+    if (geometry.vertical1.present && !geometry.vertical1.driven) {
+        deltaY = deltaVertical1;
+        verticalOffset = geometry.vertical1.offset;
+    } else if (geometry.vertical2.present && !geometry.vertical2.driven) {
+        deltaY = deltaVertical2;
+        verticalOffset = geometry.vertical2.offset;
+    } else if (geometry.vertical1.present) {
+        deltaY = deltaVertical1;
+        verticalOffset = geometry.vertical1.offset;
+    } else if (geometry.vertical2.present) {
+        deltaY = deltaVertical2;
+        verticalOffset = geometry.vertical2.offset;
+    }
+    if (geometry.horizontal1.present) {
+        deltaX = deltaHorizontal1;
+        horizontalOffset = geometry.horizontal1.offset;
+    } else if (geometry.horizontal2.present) {
+        deltaX = deltaHorizontal2;
+        horizontalOffset = geometry.horizontal2.offset;
+    }
+
+    // 4) Calculate local x and y
+    // The tracking center moves along an arc whose length is the wheel travel corrected for the wheel offset. Its
+    // chord points along the average heading. The midpoint method uses the arc length as the chord length, which is
+    // second order accurate. The exact arc scales it by sinc(deltaHeading / 2), which is written this way instead of
+    // dividing by deltaHeading so it stays accurate when the robot barely turns.
+    float chordScale = 1;
+    if (integration == OdomIntegration::ARC && deltaHeading != 0)
+        chordScale = std::sin(deltaHeading / 2) / (deltaHeading / 2);
+    const float localX = (deltaX + horizontalOffset * deltaHeading) * chordScale;
+    const float localY = (deltaY + verticalOffset * deltaHeading) * chordScale;
+    localDelta = Pose(localX, localY, deltaHeading);
+
+    // 5) Calculate global x and y
+    const Pose prevPose = pose;
+    pose.x += localY * std::sin(avgHeading);
+    pose.y += localY * std::cos(avgHeading);
+    pose.x += localX * -std::cos(avgHeading);
+    pose.y += localX * std::sin(avgHeading);
+    pose.theta += deltaHeading;
+    distanceTraveled += std::sqrt(localX * localX + localY * localY);
+
+    // 6) Calculate speed
+    // the smoothing depends on dt, so the speed is filtered the same way whatever rate odometry runs at
+    const float speedSmooth = 1 - std::exp(-dt / SPEED_FILTER_TIME);
+    speed.x = smooth((pose.x - prevPose.x) / dt, speed.x, speedSmooth);
+    speed.y = smooth((pose.y - prevPose.y) / dt, speed.y, speedSmooth);
+    speed.theta = smooth((pose.theta - prevPose.theta) / dt, speed.theta, speedSmooth);
+
+    // 7) Calculate local speed
+    localSpeed.x = smooth(localX / dt, localSpeed.x, speedSmooth);
+    localSpeed.y = smooth(localY / dt, localSpeed.y, speedSmooth);
+    localSpeed.theta = smooth(deltaHeading / dt, localSpeed.theta, speedSmooth);
+}
+
+lemlib::Pose lemlib::OdomIntegrator::getPose() const { return pose; }
+
+void lemlib::OdomIntegrator::setPose(Pose pose) { this->pose = pose; }
+
+lemlib::Pose lemlib::OdomIntegrator::getSpeed() const { return speed; }
+
+lemlib::Pose lemlib::OdomIntegrator::getLocalSpeed() const { return localSpeed; }
+
+lemlib::Pose lemlib::OdomIntegrator::getLocalDelta() const { return localDelta; }
+
+float lemlib::OdomIntegrator::getDistanceTraveled() const { return distanceTraveled; }
+
+void lemlib::OdomIntegrator::setGeometry(OdomGeometry geometry) {
+    this->geometry = geometry;
+    prev = SensorSnapshot();
+    headingFilter.reset();
+}
+
+void lemlib::OdomIntegrator::setIntegration(OdomIntegration integration) { this->integration = integration; }
+
+lemlib::HeadingFilter& lemlib::OdomIntegrator::getHeadingFilter() { return headingFilter; }
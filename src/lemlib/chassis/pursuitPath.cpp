@@ -0,0 +1,148 @@
+// The implementation below is mostly based off of
+// the document written by Dawgma
+// Here is a link to the original document
+// https://www.chiefdelphi.com/uploads/default/original/3X/b/e/be0e06de00e07db66f97686505c3f4dde2e332dc.pdf
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include "lemlib/logger/logger.hpp"
+#include "lemlib/chassis/pursuitPath.hpp"
+
+/**
+ * @brief function that returns elements in a file line, separated by a delimeter
+ *
+ * @param input the raw string
+ * @param delimeter string separating the elements in the line
+ * @return std::vector<std::string> array of elements read from the file
+ */
+static std::vector<std::string> readElement(const std::string& input, const std::string& delimiter) {
+    std::string token;
+    std::string s = input;
+    std::vector<std::string> output;
+    size_t pos = 0;
+
+    // main loop
+    while ((pos = s.find(delimiter)) != std::string::npos) { // while there are still delimiters in the string
+        token = s.substr(0, pos); // processed substring
+        output.push_back(token);
+        s.erase(0, pos + delimiter.length()); // remove the read substring
+    }
+
+    output.push_back(s); // add the last element to the returned string
+
+    return output;
+}
+
+/**
+ * @brief Convert a string to hex
+ *
+ * @param input the string to convert
+ * @return std::string hexadecimal output
+ */
+static std::string stringToHex(const std::string& input) {
+    static const char hex_digits[] = "0123456789ABCDEF";
+
+    std::string output;
+    output.reserve(input.length() * 2);
+    for (unsigned char c : input) {
+        output.push_back(hex_digits[c >> 4]);
+        output.push_back(hex_digits[c & 15]);
+    }
+    return output;
+}
+
+std::vector<lemlib::Pose> lemlib::getData(const asset& path) {
+    std::vector<lemlib::Pose> robotPath;
+
+    // format data from the asset
+    const std::string data(reinterpret_cast<char*>(path.buf), path.size);
+    const std::vector<std::string> dataLines = readElement(data, "\n");
+
+    // read the points until 'endData' is read
+    for (std::string line : dataLines) {
+        lemlib::infoSink()->debug("read raw line {}", stringToHex(line));
+        if (line == "endData" || line == "endData\r") break;
+        const std::vector<std::string> pointInput = readElement(line, ", "); // parse line
+        // check if the line was read correctly
+        if (pointInput.size() != 3) {
+            lemlib::infoSink()->error("Failed to read path file! Are you using the right format? Raw line: {}",
+                                      stringToHex(line));
+            break;
+        }
+        lemlib::Pose pathPoint(0, 0);
+        pathPoint.x = std::stof(pointInput.at(0)); // x position
+        pathPoint.y = std::stof(pointInput.at(1)); // y position
+        pathPoint.theta = std::stof(pointInput.at(2)); // velocity
+        robotPath.push_back(pathPoint); // save data
+        lemlib::infoSink()->debug("read point {}", format_as(pathPoint));
+    }
+
+    return robotPath;
+}
+
+int lemlib::findClosest(const Pose& pose, const std::vector<Pose>& path) {
+    int closestPoint = 0;
+    float closestDist = INFINITY;
+
+    // loop through all path points
+    for (size_t i = 0; i < path.size(); i++) {
+        const float dist = pose.distance(path.at(i));
+        if (dist < closestDist) { // new closest point
+            closestDist = dist;
+            closestPoint = i;
+        }
+    }
+
+    return closestPoint;
+}
+
+float lemlib::circleIntersect(const Pose& p1, const Pose& p2, const Pose& pose, float lookaheadDist) {
+    // calculations
+    // uses the quadratic formula to calculate intersection points
+    lemlib::Pose d = p2 - p1;
+    lemlib::Pose f = p1 - pose;
+    float a = d * d;
+    float b = 2 * (f * d);
+    float c = (f * f) - lookaheadDist * lookaheadDist;
+    float discriminant = b * b - 4 * a * c;
+
+    // if a possible intersection was found
+    if (discriminant >= 0) {
+        discriminant = sqrt(discriminant);
+        float t1 = (-b - discriminant) / (2 * a);
+        float t2 = (-b + discriminant) / (2 * a);
+
+        // prioritize further down the path
+        if (t2 >= 0 && t2 <= 1) return t2;
+        else if (t1 >= 0 && t1 <= 1) return t1;
+    }
+
+    // no intersection found
+    return -1;
+}
+
+lemlib::Pose lemlib::lookaheadPoint(const Pose& lastLookahead, const Pose& pose, const std::vector<Pose>& path,
+                                    int closest, float lookaheadDist) {
+    // optimizations applied:
+    // only consider intersections that have an index greater than or equal to the point closest
+    // to the robot
+    // and intersections that have an index greater than or equal to the index of the last
+    // lookahead point
+    const int start = std::max(closest, int(lastLookahead.theta));
+    for (int i = start; i < int(path.size()) - 1; i++) {
+        lemlib::Pose lastPathPose = path.at(i);
+        lemlib::Pose currentPathPose = path.at(i + 1);
+
+        float t = circleIntersect(lastPathPose, currentPathPose, pose, lookaheadDist);
+
+        if (t != -1) {
+            lemlib::Pose lookahead = lastPathPose.lerp(currentPathPose, t);
+            lookahead.theta = i;
+            return lookahead;
+        }
+    }
+
+    // robot deviated from path, use last lookahead point
+    return lastLookahead;
+}
@@ -0,0 +1,294 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "lemlib/chassis/rangeTable.hpp"
+
+// stored in place of a distance too long to store, when the beam is almost parallel to the wall
+constexpr uint16_t OUT_OF_RANGE = UINT16_MAX;
+// the first bytes of a table, which change whenever the format does
+constexpr char MAGIC[4] = {'R', 'T', 'B', '1'};
+
+/**
+ * @brief Interpolate between two stored samples, the same way when encoding and decoding
+ *
+ * Integer maths, so the encoder knows exactly what the decoder will fill in
+ *
+ * @param a the first sample
+ * @param b the last sample
+ * @param step how far past a the sample is
+ * @param steps how far past a b is
+ * @return uint16_t the sample
+ */
+static uint16_t interpolateSample(uint16_t a, uint16_t b, int step, int steps) {
+    if (a == OUT_OF_RANGE || b == OUT_OF_RANGE) return OUT_OF_RANGE;
+    const int32_t difference = (static_cast<int32_t>(b) - a) * step;
+    // round to the nearest, away from 0 on ties
+    const int32_t rounded = (difference >= 0 ? difference + steps / 2 : difference - steps / 2) / steps;
+    return a + rounded;
+}
+
+/**
+ * @brief Reads values out of a buffer, and remembers if it ran past the end
+ */
+class Reader {
+    public:
+        Reader(const uint8_t* data, size_t size)
+            : data(data),
+              size(size) {}
+
+        template <typename T> T read() {
+            T value {};
+            if (position + sizeof(T) > size) {
+                failed = true;
+                return value;
+            }
+            std::memcpy(&value, data + position, sizeof(T));
+            position += sizeof(T);
+            return value;
+        }
+
+        bool failed = false;
+    private:
+        const uint8_t* data;
+        size_t size;
+        size_t position = 0;
+};
+
+/**
+ * @brief Append a value to a buffer
+ *
+ * @param buffer the buffer
+ * @param value the value
+ */
+template <typename T> static void write(std::vector<uint8_t>& buffer, T value) {
+    const size_t position = buffer.size();
+    buffer.resize(position + sizeof(T));
+    std::memcpy(buffer.data() + position, &value, sizeof(T));
+}
+
+/**
+ * @brief Cast the beam of a distance sensor at the walls perpendicular to x, and at the walls perpendicular to y
+ *
+ * @param mount where the sensor is mounted
+ * @param x x position of the tracking center, in inches
+ * @param y y position of the tracking center, in inches
+ * @param theta heading of the robot, in radians
+ * @param fieldHalfSize distance from the center of the field to each wall, in inches
+ * @return std::array<float, 2> distance to the x wall and to the y wall the beam faces, in inches, whatever the
+ * sensor's range. INFINITY if the beam is parallel to the wall
+ */
+static std::array<float, 2> castWalls(const lemlib::DistanceMount& mount, float x, float y, float theta,
+                                      float fieldHalfSize) {
+    const float sinTheta = std::sin(theta);
+    const float cosTheta = std::cos(theta);
+    const float sensorX = x + mount.x * cosTheta + mount.y * sinTheta;
+    const float sensorY = y + mount.y * cosTheta - mount.x * sinTheta;
+    const float beamX = std::sin(theta + mount.angle);
+    const float beamY = std::cos(theta + mount.angle);
+    float expectedX = INFINITY, expectedY = INFINITY;
+    if (beamX > 1e-6) expectedX = (fieldHalfSize - sensorX) / beamX;
+    else if (beamX < -1e-6) expectedX = (-fieldHalfSize - sensorX) / beamX;
+    if (beamY > 1e-6) expectedY = (fieldHalfSize - sensorY) / beamY;
+    else if (beamY < -1e-6) expectedY = (-fieldHalfSize - sensorY) / beamY;
+    // a sensor pushed past a wall is touching it
+    return {std::fmax(expectedX, 0.0f), std::fmax(expectedY, 0.0f)};
+}
+
+float lemlib::castRange(const DistanceMount& mount, float x, float y, float theta, float fieldHalfSize) {
+    // the beam hits whichever of the two walls it faces is closer
+    const std::array<float, 2> walls = castWalls(mount, x, y, theta, fieldHalfSize);
+    const float expected = std::fmin(walls[0], walls[1]);
+    return expected > mount.maxRange ? INFINITY : expected;
+}
+
+lemlib::RangeTable lemlib::RangeTable::build(const DistanceMount* mounts, uint32_t sides, const RangeTableGrid& grid) {
+    RangeTable table;
+    if (grid.positions < 2 || grid.headings < 1 || grid.resolution <= 0) return table;
+    table.grid = grid;
+    const float cell = 2 * grid.fieldHalfSize / (grid.positions - 1);
+    for (int side = 0; side < DISTANCE_SIDES; side++) {
+        if (!(sides & (1u << side))) continue;
+        const DistanceMount& mount = mounts[side];
+        table.mounts[side] = mount;
+        table.offsets[side] = table.ranges.size();
+        for (int wall = 0; wall < 2; wall++) {
+            for (int h = 0; h < grid.headings; h++) {
+                const float theta = 2 * M_PI * h / grid.headings;
+                for (int iy = 0; iy < grid.positions; iy++) {
+                    for (int ix = 0; ix < grid.positions; ix++) {
+                        const float range = castWalls(mount, -grid.fieldHalfSize + ix * cell,
+                                                      -grid.fieldHalfSize + iy * cell, theta, grid.fieldHalfSize)[wall];
+                        const float steps = std::round(range / grid.resolution);
+                        table.ranges.push_back(steps < OUT_OF_RANGE ? steps : OUT_OF_RANGE);
+                    }
+                }
+            }
+        }
+    }
+    return table;
+}
+
+std::vector<uint8_t> lemlib::RangeTable::encode() const {
+    std::vector<uint8_t> buffer(MAGIC, MAGIC + sizeof(MAGIC));
+    write<float>(buffer, grid.fieldHalfSize);
+    write<uint16_t>(buffer, grid.positions);
+    write<uint16_t>(buffer, grid.headings);
+    write<float>(buffer, grid.resolution);
+    write<float>(buffer, grid.tolerance);
+    uint8_t sides = 0;
+    for (int side = 0; side < DISTANCE_SIDES; side++) sides |= (offsets[side] >= 0) << side;
+    write<uint8_t>(buffer, sides);
+    for (int side = 0; side < DISTANCE_SIDES; side++) {
+        if (offsets[side] < 0) continue;
+        const DistanceMount& mount = mounts[side];
+        for (float value : {mount.x, mount.y, mount.angle, mount.maxRange, mount.minNoise, mount.rangeNoise})
+            write<float>(buffer, value);
+    }
+
+    // each row along x is stored as its first sample, then a gap and a sample for every sample kept after it. The
+    // samples in between are interpolated from the ones either side
+    const int tolerance = std::floor(grid.tolerance / grid.resolution);
+    for (int side = 0; side < DISTANCE_SIDES; side++) {
+        if (offsets[side] < 0) continue;
+        for (int row = 0; row < 2 * grid.headings * grid.positions; row++) {
+            const uint16_t* samples = &ranges[offsets[side] + row * grid.positions];
+            write<uint16_t>(buffer, samples[0]);
+            int kept = 0;
+            while (kept < grid.positions - 1) {
+                // keep going while the samples so far can be interpolated from the last one kept
+                int next = kept + 1;
+                for (int end = kept + 2; end < grid.positions && end - kept <= UINT8_MAX; end++) {
+                    bool fits = true;
+                    for (int i = kept + 1; i < end && fits; i++) {
+                        const uint16_t predicted = interpolateSample(samples[kept], samples[end], i - kept, end - kept);
+                        if (predicted == OUT_OF_RANGE || samples[i] == OUT_OF_RANGE) fits = predicted == samples[i];
+                        else fits = std::abs(static_cast<int>(predicted) - samples[i]) <= tolerance;
+                    }
+                    if (!fits) break;
+                    next = end;
+                }
+                write<uint8_t>(buffer, next - kept);
+                write<uint16_t>(buffer, samples[next]);
+                kept = next;
+            }
+        }
+    }
+    return buffer;
+}
+
+bool lemlib::RangeTable::load(const asset& file) {
+    *this = RangeTable();
+    Reader reader(file.buf, file.size);
+    char magic[sizeof(MAGIC)];
+    for (char& c : magic) c = reader.read<char>();
+    if (std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) return false;
+    RangeTableGrid fileGrid;
+    fileGrid.fieldHalfSize = reader.read<float>();
+    fileGrid.positions = reader.read<uint16_t>();
+    fileGrid.headings = reader.read<uint16_t>();
+    fileGrid.resolution = reader.read<float>();
+    fileGrid.tolerance = reader.read<float>();
+    const uint8_t sides = reader.read<uint8_t>();
+    if (reader.failed || fileGrid.positions < 2 || fileGrid.headings < 1) return false;
+    std::array<DistanceMount, DISTANCE_SIDES> fileMounts {};
+    std::array<int, DISTANCE_SIDES> fileOffsets = {-1, -1, -1, -1};
+    int sensors = 0;
+    for (int side = 0; side < DISTANCE_SIDES; side++) {
+        if (!(sides & (1u << side))) continue;
+        DistanceMount& mount = fileMounts[side];
+        for (float* value : {&mount.x, &mount.y, &mount.angle, &mount.maxRange, &mount.minNoise, &mount.rangeNoise})
+            *value = reader.read<float>();
+        fileOffsets[side] = sensors++ * 2 * fileGrid.headings * fileGrid.positions * fileGrid.positions;
+    }
+
+    std::vector<uint16_t> fileRanges(sensors * 2 * fileGrid.headings * fileGrid.positions * fileGrid.positions);
+    for (int row = 0; row < sensors * 2 * fileGrid.headings; row++) {
+        for (int iy = 0; iy < fileGrid.positions; iy++) {
+            uint16_t* samples = &fileRanges[(row * fileGrid.positions + iy) * fileGrid.positions];
+            samples[0] = reader.read<uint16_t>();
+            int kept = 0;
+            while (kept < fileGrid.positions - 1) {
+                const int gap = reader.read<uint8_t>();
+                if (reader.failed || gap == 0 || kept + gap >= fileGrid.positions) return false;
+                samples[kept + gap] = reader.read<uint16_t>();
+                for (int i = 1; i < gap; i++)
+                    samples[kept + i] = interpolateSample(samples[kept], samples[kept + gap], i, gap);
+                kept += gap;
+            }
+        }
+    }
+    if (reader.failed) return false;
+    grid = fileGrid;
+    mounts = fileMounts;
+    offsets = fileOffsets;
+    ranges = std::move(fileRanges);
+    return true;
+}
+
+bool lemlib::RangeTable::isLoaded() const { return !ranges.empty(); }
+
+bool lemlib::RangeTable::hasSensor(DistanceSide side) const { return offsets[static_cast<int>(side)] >= 0; }
+
+const lemlib::DistanceMount& lemlib::RangeTable::getMount(DistanceSide side) const {
+    return mounts[static_cast<int>(side)];
+}
+
+bool lemlib::RangeTable::matches(const DistanceMount* robotMounts, uint32_t sides) const {
+    for (int side = 0; side < DISTANCE_SIDES; side++) {
+        if (!(sides & (1u << side))) continue;
+        if (offsets[side] < 0) return false;
+        const DistanceMount& a = mounts[side];
+        const DistanceMount& b = robotMounts[side];
+        if (std::fabs(a.x - b.x) > 0.01 || std::fabs(a.y - b.y) > 0.01 || std::fabs(a.angle - b.angle) > 0.01 ||
+            std::fabs(a.maxRange - b.maxRange) > 0.01)
+            return false;
+    }
+    return true;
+}
+
+float lemlib::RangeTable::getExpected(DistanceSide side, float x, float y, float theta) const {
+    const uint16_t* samples = &ranges[offsets[static_cast<int>(side)]];
+    const int positions = grid.positions;
+    const float scale = (positions - 1) / (2 * grid.fieldHalfSize);
+
+    // the cell the pose is in, and how far across it
+    const float gridX = std::clamp((x + grid.fieldHalfSize) * scale, 0.0f, positions - 1.0f);
+    const float gridY = std::clamp((y + grid.fieldHalfSize) * scale, 0.0f, positions - 1.0f);
+    const int ix = std::min(static_cast<int>(gridX), positions - 2);
+    const int iy = std::min(static_cast<int>(gridY), positions - 2);
+    const float fx = gridX - ix;
+    const float fy = gridY - iy;
+    float gridHeading = theta * static_cast<float>(grid.headings / (2 * M_PI));
+    gridHeading -= std::floor(gridHeading / grid.headings) * grid.headings;
+    const int ih = static_cast<int>(gridHeading) % grid.headings;
+    const float fh = gridHeading - std::floor(gridHeading);
+    const int nextHeading = ih + 1 == grid.headings ? 0 : ih + 1;
+
+    // trilinear interpolation of the distance to each wall. Each distance is linear in x and y, so only the heading
+    // adds any error. Distances too long to store are left out, since the other wall is much closer there anyway
+    float expected = INFINITY;
+    for (int wall = 0; wall < 2; wall++) {
+        float sum = 0, weight = 0;
+        for (int h = 0; h < 2; h++) {
+            const uint16_t* plane =
+                samples + ((wall * grid.headings) + (h == 0 ? ih : nextHeading)) * positions * positions;
+            const float weightH = h == 0 ? 1 - fh : fh;
+            for (int dy = 0; dy < 2; dy++) {
+                const uint16_t* row = plane + (iy + dy) * positions + ix;
+                const float weightHY = weightH * (dy == 0 ? 1 - fy : fy);
+                for (int dx = 0; dx < 2; dx++) {
+                    if (row[dx] == OUT_OF_RANGE) continue;
+                    const float cornerWeight = weightHY * (dx == 0 ? 1 - fx : fx);
+                    sum += cornerWeight * row[dx];
+                    weight += cornerWeight;
+                }
+            }
+        }
+        if (weight >= 0.5) expected = std::fmin(expected, sum / weight * grid.resolution);
+    }
+    return expected > mounts[static_cast<int>(side)].maxRange ? INFINITY : expected;
+}
+
+const lemlib::RangeTableGrid& lemlib::RangeTable::getGrid() const { return grid; }
+
+size_t lemlib::RangeTable::getMemoryUsage() const { return ranges.size() * sizeof(uint16_t); }
@@ -0,0 +1,85 @@
+#include <mutex>
+#include "lemlib/util.hpp"
+#include "lemlib/chassis/sensorLog.hpp"
+
+bool lemlib::SensorLog::start(const char* path) {
+    std::lock_guard lock(mutex);
+    if (file != nullptr) return false;
+    file = std::fopen(path, "w");
+    if (file == nullptr) return false;
+    // the replay tool skips lines that don't start with a number
+    std::fputs("time_us,vertical1,vertical2,horizontal1,horizontal2,imu_deg,front_mm,front_confidence,back_mm,"
+               "back_confidence,left_mm,left_confidence,right_mm,right_confidence\n",
+               file);
+    // record() isn't running yet, so nothing can be added to the buffer while it is emptied
+    tail.store(head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    dropped.store(0, std::memory_order_relaxed);
+    hasOrigin = false;
+    hasImuOrigin = false;
+    if (task == nullptr) {
+        task = new pros::Task([this] {
+            while (true) {
+                mutex.lock();
+                if (file != nullptr) write();
+                mutex.unlock();
+                pros::delay(WRITE_PERIOD);
+            }
+        });
+    }
+    recording.store(true, std::memory_order_release);
+    return true;
+}
+
+void lemlib::SensorLog::stop() {
+    recording.store(false, std::memory_order_release);
+    std::lock_guard lock(mutex);
+    if (file == nullptr) return;
+    write();
+    std::fclose(file);
+    file = nullptr;
+}
+
+bool lemlib::SensorLog::isRecording() const { return recording.load(std::memory_order_relaxed); }
+
+void lemlib::SensorLog::record(const SensorSnapshot& snapshot) {
+    if (!recording.load(std::memory_order_acquire)) return;
+    const uint32_t next = head.load(std::memory_order_relaxed);
+    if (next - tail.load(std::memory_order_acquire) >= CAPACITY) {
+        dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return;
+    }
+    buffer[next % CAPACITY] = snapshot;
+    head.store(next + 1, std::memory_order_release);
+}
+
+uint32_t lemlib::SensorLog::getDropped() const { return dropped.load(std::memory_order_relaxed); }
+
+void lemlib::SensorLog::write() {
+    const uint32_t end = head.load(std::memory_order_acquire);
+    uint32_t next = tail.load(std::memory_order_relaxed);
+    for (; next != end; next++) {
+        const SensorSnapshot& snapshot = buffer[next % CAPACITY];
+        if (!hasOrigin) {
+            origin = snapshot;
+            hasOrigin = true;
+        }
+        if (!hasImuOrigin && snapshot.imuValid) {
+            imuOrigin = snapshot.imuRotation;
+            hasImuOrigin = true;
+        }
+        std::fprintf(file, "%llu,%.4f,%.4f,%.4f,%.4f,", static_cast<unsigned long long>(snapshot.timestamp),
+                     snapshot.vertical1 - origin.vertical1, snapshot.vertical2 - origin.vertical2,
+                     snapshot.horizontal1 - origin.horizontal1, snapshot.horizontal2 - origin.horizontal2);
+        // an empty field means the IMU didn't give a reading
+        if (snapshot.imuValid) std::fprintf(file, "%.4f", radToDeg(snapshot.imuRotation - imuOrigin));
+        for (const DistanceReading& reading : snapshot.distances) {
+            std::fprintf(file, ",%ld,%ld", static_cast<long>(reading.valid ? reading.distance : -1),
+                         static_cast<long>(reading.confidence));
+        }
+        std::fputc('\n', file);
+    }
+    // the slots can be reused once they have been written
+    tail.store(next, std::memory_order_release);
+    // so a log survives the robot being turned off
+    std::fflush(file);
+}
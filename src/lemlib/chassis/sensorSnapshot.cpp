@@ -0,0 +1,80 @@
+#include "pros/rtos.hpp"
+#include "pros/distance.hpp"
+#include "lemlib/util.hpp"
+#include "lemlib/chassis/chassis.hpp"
+#include "lemlib/chassis/sensorSnapshot.hpp"
+#include "lemlib/chassis/trackingWheel.hpp"
+
+// the distance reported by the sensor when it can't see anything
+static constexpr int32_t NO_OBJECT_MM = 9999;
+
+static pros::Mutex snapshotMutex;
+static lemlib::SensorSnapshot latestSnapshot;
+static lemlib::OdomSensors snapshotSensors(nullptr, nullptr, nullptr, nullptr, nullptr, nullptr);
+static float trackWidth = 0;
+static std::array<pros::Distance*, lemlib::DISTANCE_SIDES> distanceSensors {};
+
+void lemlib::setSnapshotSensors(const OdomSensors& sensors, const Drivetrain& drivetrain) {
+    snapshotMutex.take();
+    snapshotSensors = sensors;
+    trackWidth = drivetrain.trackWidth;
+    for (int i = 0; i < DISTANCE_SIDES; i++) {
+        distanceSensors[i] = sensors.distances ? sensors.distances->getSensor(static_cast<DistanceSide>(i)) : nullptr;
+    }
+    latestSnapshot = SensorSnapshot();
+    snapshotMutex.give();
+}
+
+lemlib::SensorSnapshot lemlib::updateSensorSnapshot() {
+    SensorSnapshot snapshot;
+    const SensorSnapshot prev = getSensorSnapshot();
+
+    // read every sensor exactly once
+    snapshot.timestamp = pros::micros();
+    if (snapshotSensors.vertical1) snapshot.vertical1 = snapshotSensors.vertical1->getDistanceTraveled();
+    if (snapshotSensors.vertical2) snapshot.vertical2 = snapshotSensors.vertical2->getDistanceTraveled();
+    if (snapshotSensors.horizontal1) snapshot.horizontal1 = snapshotSensors.horizontal1->getDistanceTraveled();
+    if (snapshotSensors.horizontal2) snapshot.horizontal2 = snapshotSensors.horizontal2->getDistanceTraveled();
+    if (snapshotSensors.imu) {
+        const double rotation = snapshotSensors.imu->get_rotation();
+        snapshot.imuValid = rotation != PROS_ERR_F;
+        if (snapshot.imuValid) snapshot.imuRotation = degToRad(rotation);
+    }
+    for (int i = 0; i < DISTANCE_SIDES; i++) {
+        if (distanceSensors[i] == nullptr) continue;
+        DistanceReading& reading = snapshot.distances[i];
+        reading.distance = distanceSensors[i]->get_distance();
+        reading.confidence = distanceSensors[i]->get_confidence();
+        reading.valid = reading.distance != PROS_ERR && reading.distance != NO_OBJECT_MM;
+    }
+
+    // calculate velocities from the previous snapshot, if there is one
+    if (prev.timestamp != 0) {
+        snapshot.dt = (snapshot.timestamp - prev.timestamp) / 1000000.0;
+        if (snapshot.dt > 0) {
+            const float deltaVertical1 = snapshot.vertical1 - prev.vertical1;
+            const float deltaVertical2 = snapshot.vertical2 - prev.vertical2;
+            if (snapshotSensors.vertical1 && snapshotSensors.vertical2)
+                snapshot.forwardVelocity = (deltaVertical1 + deltaVertical2) / 2 / snapshot.dt;
+            else if (snapshotSensors.vertical1) snapshot.forwardVelocity = deltaVertical1 / snapshot.dt;
+            else if (snapshotSensors.vertical2) snapshot.forwardVelocity = deltaVertical2 / snapshot.dt;
+
+            if (snapshot.imuValid && prev.imuValid)
+                snapshot.yawRate = (snapshot.imuRotation - prev.imuRotation) / snapshot.dt;
+            else if (snapshotSensors.vertical1 && snapshotSensors.vertical2 && trackWidth != 0)
+                snapshot.yawRate = (deltaVertical1 - deltaVertical2) / trackWidth / snapshot.dt;
+        }
+    }
+
+    snapshotMutex.take();
+    latestSnapshot = snapshot;
+    snapshotMutex.give();
+    return snapshot;
+}
+
+lemlib::SensorSnapshot lemlib::getSensorSnapshot() {
+    snapshotMutex.take();
+    const SensorSnapshot snapshot = latestSnapshot;
+    snapshotMutex.give();
+    return snapshot;
+}
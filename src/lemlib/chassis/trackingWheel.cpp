@@ -1,3 +1,4 @@
+#include <algorithm>
 #include "lemlib/chassis/trackingWheel.hpp"
 #include "lemlib/util.hpp"
 #include "pros/abstract_motor.hpp"
@@ -19,18 +20,41 @@ lemlib::TrackingWheel::TrackingWheel(pros::Rotation* encoder, float wheelDiamete
     this->gearRatio = gearRatio;
 }
 
-lemlib::TrackingWheel::TrackingWheel(pros::MotorGroup* motors, float wheelDiameter, float distance, float rpm) {
+lemlib::TrackingWheel::TrackingWheel(pros::MotorGroup* motors, float wheelDiameter, float distance, float rpm,
+                                     MotorAggregation aggregation) {
     this->motors = motors;
     this->motors->set_encoder_units_all(pros::E_MOTOR_ENCODER_ROTATIONS);
     this->diameter = wheelDiameter;
     this->distance = distance;
     this->rpm = rpm;
+    this->aggregation = aggregation;
+    this->cacheMotorScales();
+}
+
+void lemlib::TrackingWheel::cacheMotorScales() {
+    this->motorCount = std::min<int>(this->motors->size(), MAX_MOTORS);
+    for (int i = 0; i < this->motorCount; i++) {
+        float in;
+        switch (this->motors->get_gearing(i)) {
+            case pros::MotorGears::red: in = 100; break;
+            case pros::MotorGears::green: in = 200; break;
+            case pros::MotorGears::blue: in = 600; break;
+            default: in = 200; break;
+        }
+        this->motorScales[i] = (diameter * M_PI) * (rpm / in);
+    }
 }
 
 void lemlib::TrackingWheel::reset() {
     if (this->encoder != nullptr) this->encoder->reset();
     if (this->rotation != nullptr) this->rotation->reset_position();
-    if (this->motors != nullptr) this->motors->tare_position_all();
+    if (this->motors != nullptr) {
+        this->motors->tare_position_all();
+        // the gearing may have changed since construction, so cache it again
+        this->cacheMotorScales();
+        this->prevMotorPositions.fill(0);
+        this->motorDistance = 0;
+    }
 }
 
 float lemlib::TrackingWheel::getDistanceTraveled() {
@@ -39,26 +63,55 @@ float lemlib::TrackingWheel::getDistanceTraveled() {
     } else if (this->rotation != nullptr) {
         return (float(this->rotation->get_position()) * this->diameter * M_PI / 36000) / this->gearRatio;
     } else if (this->motors != nullptr) {
-        // get distance traveled by each motor
-        std::vector<pros::MotorGears> gearsets = this->motors->get_gearing_all();
-        std::vector<double> positions = this->motors->get_position_all();
-        std::vector<float> distances;
-        for (int i = 0; i < this->motors->size(); i++) {
-            float in;
-            switch (gearsets[i]) {
-                case pros::MotorGears::red: in = 100; break;
-                case pros::MotorGears::green: in = 200; break;
-                case pros::MotorGears::blue: in = 600; break;
-                default: in = 200; break;
+        // get the distance traveled by each motor since the last call
+        std::array<float, MAX_MOTORS> deltas;
+        int count = 0;
+        for (int i = 0; i < this->motorCount; i++) {
+            const double position = this->motors->get_position(i);
+            // skip disconnected motors, and don't count the jump when they reconnect
+            if (position == PROS_ERR_F) {
+                this->prevMotorPositions[i] = PROS_ERR_F;
+                continue;
             }
-            distances.push_back(positions[i] * (diameter * M_PI) * (rpm / in));
+            const double prevPosition = this->prevMotorPositions[i];
+            this->prevMotorPositions[i] = position;
+            if (prevPosition == PROS_ERR_F) continue;
+            deltas[count++] = (position - prevPosition) * this->motorScales[i];
         }
-        return lemlib::avg(distances);
+        if (count == 0) return this->motorDistance;
+
+        // combine them, rejecting outliers if needed
+        float delta = 0;
+        if (this->aggregation == MotorAggregation::MEAN || count < 3) {
+            for (int i = 0; i < count; i++) delta += deltas[i];
+            delta /= count;
+        } else {
+            std::nth_element(deltas.begin(), deltas.begin() + count / 2, deltas.begin() + count);
+            const float median = deltas[count / 2];
+            if (this->aggregation == MotorAggregation::MEDIAN) {
+                delta = median;
+            } else {
+                int outlier = 0;
+                for (int i = 1; i < count; i++) {
+                    if (std::fabs(deltas[i] - median) > std::fabs(deltas[outlier] - median)) outlier = i;
+                }
+                for (int i = 0; i < count; i++) {
+                    if (i != outlier) delta += deltas[i];
+                }
+                delta /= count - 1;
+            }
+        }
+        this->motorDistance += delta;
+        return this->motorDistance;
     } else {
         return 0;
     }
 }
 
+void lemlib::TrackingWheel::setDataRate(uint32_t rate) {
+    if (this->rotation != nullptr) this->rotation->set_data_rate(rate);
+}
+
 float lemlib::TrackingWheel::getOffset() { return this->distance; }
 
 int lemlib::TrackingWheel::getType() {
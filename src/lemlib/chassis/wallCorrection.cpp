@@ -0,0 +1,67 @@
+#include <cmath>
+#include "lemlib/chassis/wallCorrection.hpp"
+
+lemlib::WallCorrection lemlib::computeWallCorrection(const Pose& pose, const DistanceReading* readings,
+                                                     const DistanceMount* mounts, int count,
+                                                     const WallCorrectionSettings& settings, uint32_t mask) {
+    const float sinTheta = std::sin(pose.theta);
+    const float cosTheta = std::cos(pose.theta);
+    const float minCos = std::cos(settings.maxIncidence);
+    const float wall = settings.fieldHalfSize;
+
+    // normal equations of the least squares fit. Each reading constrains only x or only y, so they are diagonal
+    float weightX = 0, weightedX = 0;
+    float weightY = 0, weightedY = 0;
+    WallCorrection result;
+
+    for (int i = 0; i < count; i++) {
+        const DistanceReading& reading = readings[i];
+        const DistanceMount& mount = mounts[i];
+        if (!(mask & (1u << i)) || !reading.valid || reading.confidence < settings.minConfidence) continue;
+        const float measured = reading.distance / 25.4;
+        if (settings.limitRange && measured > mount.maxRange) continue;
+
+        // position of the sensor relative to the tracking center, and the direction of its beam, on the field
+        const float offsetX = mount.x * cosTheta + mount.y * sinTheta;
+        const float offsetY = mount.y * cosTheta - mount.x * sinTheta;
+        const float beamX = std::sin(pose.theta + mount.angle);
+        const float beamY = std::cos(pose.theta + mount.angle);
+        const float sensorX = pose.x + offsetX;
+        const float sensorY = pose.y + offsetY;
+
+        // cast the beam to find the wall it should hit first
+        float expectedX = INFINITY, expectedY = INFINITY;
+        if (beamX > 1e-6) expectedX = (wall - sensorX) / beamX;
+        else if (beamX < -1e-6) expectedX = (-wall - sensorX) / beamX;
+        if (beamY > 1e-6) expectedY = (wall - sensorY) / beamY;
+        else if (beamY < -1e-6) expectedY = (-wall - sensorY) / beamY;
+        const bool hitsX = expectedX < expectedY;
+        const float expected = hitsX ? expectedX : expectedY;
+        const float incidence = std::fabs(hitsX ? beamX : beamY);
+        if (expected < 0 || incidence < minCos || std::fabs(measured - expected) > settings.gate) continue;
+
+        // solve the beam for the position of the tracking center along the wall normal
+        const float noise = std::fmax(mount.minNoise, mount.rangeNoise * measured) * incidence;
+        const float weight = 1 / (noise * noise);
+        if (hitsX) {
+            const float wallX = beamX > 0 ? wall : -wall;
+            weightX += weight;
+            weightedX += weight * (wallX - measured * beamX - offsetX);
+        } else {
+            const float wallY = beamY > 0 ? wall : -wall;
+            weightY += weight;
+            weightedY += weight * (wallY - measured * beamY - offsetY);
+        }
+        result.used++;
+    }
+
+    if (weightX > 0) {
+        result.hasX = true;
+        result.x = weightedX / weightX;
+    }
+    if (weightY > 0) {
+        result.hasY = true;
+        result.y = weightedY / weightY;
+    }
+    return result;
+}
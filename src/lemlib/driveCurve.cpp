@@ -1,4 +1,4 @@
-#include "lemlib/util.hpp"
+#include "lemlib/driveCurve.hpp"
 #include <cmath>
 
 namespace lemlib {
@@ -15,9 +15,9 @@ float ExpoDriveCurve::curve(float input) {
     // g127 is the output of g(127) as defined in the Desmos graph
     const float g127 = 127 - deadband;
     // i is the output of i(x) as defined in the Desmos graph
-    const float i = pow(curveGain, g - 127) * g * sgn(input);
+    const float i = pow(curveGain, g - 127) * g * std::copysign(1.0f, input);
     // i127 is the output of i(127) as defined in the Desmos graph
     const float i127 = pow(curveGain, g127 - 127) * g127;
-    return (127.0 - minOutput) / (127) * i * 127 / i127 + minOutput * sgn(input);
+    return (127.0 - minOutput) / (127) * i * 127 / i127 + minOutput * std::copysign(1.0f, input);
 }
 } // namespace lemlib
\ No newline at end of file
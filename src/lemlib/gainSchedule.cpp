@@ -0,0 +1,64 @@
+#include <algorithm>
+#include <cmath>
+#include "lemlib/gainSchedule.hpp"
+
+namespace lemlib {
+/**
+ * @brief Find where a value is on an axis
+ *
+ * @param axis the axis, in ascending order
+ * @param value the value
+ * @param index set to the index of the point before the value
+ * @return float how far the value is from that point to the next, from 0 to 1
+ */
+static float locate(const std::vector<float>& axis, float value, size_t& index) {
+    if (axis.size() == 1 || value <= axis.front()) {
+        index = 0;
+        return 0;
+    }
+    if (value >= axis.back()) {
+        index = axis.size() - 2;
+        return 1;
+    }
+    index = std::upper_bound(axis.begin(), axis.end(), value) - axis.begin() - 1;
+    return (value - axis[index]) / (axis[index + 1] - axis[index]);
+}
+
+/**
+ * @brief Interpolate between two sets of gains
+ *
+ * @param a the gains at 0
+ * @param b the gains at 1
+ * @param t how far to go from a to b
+ * @return PIDGains the gains
+ */
+static PIDGains lerp(const PIDGains& a, const PIDGains& b, float t) {
+    return {a.kP + (b.kP - a.kP) * t, a.kI + (b.kI - a.kI) * t, a.kD + (b.kD - a.kD) * t};
+}
+
+GainSchedule::GainSchedule(std::vector<float> errors, std::vector<float> velocities,
+                           std::vector<std::vector<PIDGains>> gains)
+    : errors(std::move(errors)),
+      velocities(std::move(velocities)),
+      gains(std::move(gains)) {}
+
+bool GainSchedule::isValid() const {
+    if (errors.empty() || velocities.empty() || gains.size() != errors.size()) return false;
+    if (!std::is_sorted(errors.begin(), errors.end()) || !std::is_sorted(velocities.begin(), velocities.end()))
+        return false;
+    for (const std::vector<PIDGains>& row : gains)
+        if (row.size() != velocities.size()) return false;
+    return true;
+}
+
+PIDGains GainSchedule::get(float error, float velocity) const {
+    size_t row, column;
+    const float errorT = locate(errors, std::fabs(error), row);
+    const float velocityT = locate(velocities, std::fabs(velocity), column);
+    // a single point on an axis has nothing to interpolate to
+    const size_t nextRow = errors.size() > 1 ? row + 1 : row;
+    const size_t nextColumn = velocities.size() > 1 ? column + 1 : column;
+    return lerp(lerp(gains[row][column], gains[row][nextColumn], velocityT),
+                lerp(gains[nextRow][column], gains[nextRow][nextColumn], velocityT), errorT);
+}
+} // namespace lemlib
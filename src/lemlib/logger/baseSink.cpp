@@ -12,6 +12,11 @@ void BaseSink::setLowestLevel(Level lowestLevel) {
     this->lowestLevel = lowestLevel;
 }
 
+Level BaseSink::getLowestLevel() const {
+    if (!sinks.empty()) return sinks.front()->getLowestLevel();
+    return lowestLevel;
+}
+
 void BaseSink::setFormat(const std::string& logFormat) { this->logFormat = logFormat; }
 
 fmt::dynamic_format_arg_store<fmt::format_context> BaseSink::getExtraFormattingArgs(const Message& messageInfo) {
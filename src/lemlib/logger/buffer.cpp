@@ -6,7 +6,7 @@
 namespace lemlib {
 Buffer::Buffer(std::function<void(const std::string&)> bufferFunc)
     : bufferFunc(bufferFunc),
-      task([=]() { taskLoop(); }) {}
+      task([this]() { taskLoop(); }) {}
 
 bool Buffer::buffersEmpty() {
     mutex.take();
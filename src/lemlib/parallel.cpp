@@ -0,0 +1,177 @@
+#include <algorithm>
+#include "lemlib/parallel.hpp"
+
+#ifdef LEMLIB_HOST
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#endif
+
+namespace lemlib {
+static SerialBackend serialBackend;
+static ParallelBackend* parallelBackend = &serialBackend;
+
+void SerialBackend::run(std::size_t chunks, const std::function<void(std::size_t chunk)>& function) {
+    for (std::size_t chunk = 0; chunk < chunks; chunk++) function(chunk);
+}
+
+int SerialBackend::getConcurrency() const { return 1; }
+
+void setParallelBackend(ParallelBackend* backend) { parallelBackend = backend ? backend : &serialBackend; }
+
+ParallelBackend& getParallelBackend() { return *parallelBackend; }
+
+void inclusiveScan(double* values, std::size_t count, std::size_t grain) {
+    // sum each chunk on its own
+    std::vector<double> totals(chunkCount(count, grain));
+    parallelFor(count, grain, [&](std::size_t begin, std::size_t end, std::size_t chunk) {
+        double sum = 0;
+        for (std::size_t i = begin; i < end; i++) values[i] = sum += values[i];
+        totals[chunk] = sum;
+    });
+    if (totals.size() < 2) return;
+    // turn the chunk totals into the sum of every chunk before each one
+    double offset = 0;
+    for (double& total : totals) {
+        const double chunkTotal = total;
+        total = offset;
+        offset += chunkTotal;
+    }
+    parallelFor(count, grain, [&](std::size_t begin, std::size_t end, std::size_t chunk) {
+        if (chunk == 0) return;
+        for (std::size_t i = begin; i < end; i++) values[i] += totals[chunk];
+    });
+}
+
+#ifdef LEMLIB_HOST
+/**
+ * @brief The queue of chunks belonging to one thread
+ */
+struct WorkQueue {
+        std::mutex mutex;
+        std::deque<std::size_t> chunks;
+};
+
+struct ThreadPoolBackend::State {
+        std::vector<std::thread> threads;
+        // one queue per thread, and the last one for the calling thread
+        std::vector<std::unique_ptr<WorkQueue>> queues;
+        // only one loop runs at a time
+        std::mutex runMutex;
+        std::mutex wakeMutex;
+        std::condition_variable wake;
+        std::condition_variable done;
+        uint64_t generation = 0;
+        bool stopping = false;
+        const std::function<void(std::size_t)>* function = nullptr;
+        std::atomic<std::size_t> remaining {0};
+
+        /**
+         * @brief Take a chunk from the front of a thread's own queue, or from the back of another queue
+         *
+         * @param self the index of the thread's own queue
+         * @param chunk set to the chunk taken
+         * @return true if a chunk was taken
+         */
+        bool take(std::size_t self, std::size_t& chunk) {
+            {
+                WorkQueue& own = *queues[self];
+                std::lock_guard<std::mutex> lock(own.mutex);
+                if (!own.chunks.empty()) {
+                    chunk = own.chunks.front();
+                    own.chunks.pop_front();
+                    return true;
+                }
+            }
+            for (std::size_t offset = 1; offset < queues.size(); offset++) {
+                WorkQueue& victim = *queues[(self + offset) % queues.size()];
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                if (!victim.chunks.empty()) {
+                    chunk = victim.chunks.back();
+                    victim.chunks.pop_back();
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /**
+         * @brief Run chunks until there are none left to take
+         *
+         * @param self the index of the thread's own queue
+         */
+        void work(std::size_t self) {
+            std::size_t chunk;
+            while (take(self, chunk)) {
+                (*function)(chunk);
+                if (remaining.fetch_sub(1) == 1) {
+                    std::lock_guard<std::mutex> lock(wakeMutex);
+                    done.notify_all();
+                }
+            }
+        }
+};
+
+ThreadPoolBackend::ThreadPoolBackend(int threads)
+    : state(new State) {
+    if (threads <= 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 0; i < threads; i++) state->queues.emplace_back(new WorkQueue);
+    // the calling thread is the last worker, so start one fewer thread
+    for (int i = 0; i < threads - 1; i++) {
+        state->threads.emplace_back([this, i] {
+            uint64_t seen = 0;
+            while (true) {
+                {
+                    std::unique_lock<std::mutex> lock(state->wakeMutex);
+                    state->wake.wait(lock, [&] { return state->stopping || state->generation != seen; });
+                    if (state->stopping) return;
+                    seen = state->generation;
+                }
+                state->work(i);
+            }
+        });
+    }
+}
+
+ThreadPoolBackend::~ThreadPoolBackend() {
+    {
+        std::lock_guard<std::mutex> lock(state->wakeMutex);
+        state->stopping = true;
+    }
+    state->wake.notify_all();
+    for (std::thread& thread : state->threads) thread.join();
+}
+
+void ThreadPoolBackend::run(std::size_t chunks, const std::function<void(std::size_t chunk)>& function) {
+    if (chunks == 0) return;
+    if (state->threads.empty() || chunks == 1) {
+        for (std::size_t chunk = 0; chunk < chunks; chunk++) function(chunk);
+        return;
+    }
+    std::lock_guard<std::mutex> runLock(state->runMutex);
+    state->function = &function;
+    state->remaining = chunks;
+    // deal contiguous runs of chunks to each queue, so neighbouring chunks tend to run on the same thread
+    const std::size_t queues = state->queues.size();
+    for (std::size_t queue = 0; queue < queues; queue++) {
+        std::lock_guard<std::mutex> lock(state->queues[queue]->mutex);
+        for (std::size_t chunk = queue * chunks / queues; chunk < (queue + 1) * chunks / queues; chunk++)
+            state->queues[queue]->chunks.push_back(chunk);
+    }
+    {
+        std::lock_guard<std::mutex> lock(state->wakeMutex);
+        state->generation++;
+    }
+    state->wake.notify_all();
+
+    state->work(queues - 1);
+    std::unique_lock<std::mutex> lock(state->wakeMutex);
+    state->done.wait(lock, [&] { return state->remaining == 0; });
+}
+
+int ThreadPoolBackend::getConcurrency() const { return state->queues.size(); }
+#endif
+} // namespace lemlib
@@ -8,9 +8,11 @@
 #include <numeric>
 
 #include "particle_filter.h"
+#include "lemlib/parallel.hpp"
+#include "pros/rtos.hpp"
 using namespace std;
 
-void ParticleFilter::init(double x, double y, double theta, double std[]) {
+void ParticleFilter::init(double x, double y, double theta, double std[], int count) {
     // Set the number of particles. Initialize all particles to first position (based on estimates of
     //   x, y, theta and their uncertainties from GPS) and all weights to 1.
     // Add random Gaussian noise to each particle.
@@ -19,7 +21,10 @@ void ParticleFilter::init(double x, double y, double theta, double std[]) {
     weights.clear();
     particles.clear();
 
-    num_particles = 729; // set to number of files in observation directory
+    num_particles = count;
+    // a new belief, so forget how well the old one explained the observations
+    w_slow = 0;
+    w_fast = 0;
 
     weights.resize(num_particles);
     particles.resize(num_particles);
@@ -63,31 +68,36 @@ void ParticleFilter::prediction(double delta_t, double std_pos[], double velocit
     std_theta = std_pos[2];
 
 
-    for (int i = 0; i < num_particles; ++i) {
-        Particle* p = &particles[i]; // get address of particle to update
+    // each chunk of particles draws its noise from its own generator, seeded from the filter's generator, so chunks
+    // can run at the same time and the result doesn't depend on how many run at once
+    const unsigned seed = gen();
+    lemlib::parallelFor(num_particles, lemlib::DEFAULT_GRAIN, [&](size_t begin, size_t end, size_t chunk) {
+        seed_seq chunkSeed {seed, static_cast<unsigned>(chunk)};
+        default_random_engine chunkGen(chunkSeed);
+        normal_distribution<double> noise_x(0, std_x);
+        normal_distribution<double> noise_y(0, std_y);
+        normal_distribution<double> noise_theta(0, std_theta);
+
+        for (size_t i = begin; i < end; ++i) {
+            Particle* p = &particles[i]; // get address of particle to update
+
+            // use the prediction equations from the Lesson 14
+            if (fabs(yaw_rate) > 1e-5) {
+                p->x += (velocity / yaw_rate) * (sin(p->theta + yaw_rate * delta_t) - sin(p->theta));
+                p->y += (velocity / yaw_rate) * (cos(p->theta) - cos(p->theta + yaw_rate * delta_t));
+                p->theta += yaw_rate * delta_t;
+            } else {
+                p->x += velocity * delta_t * cos(p->theta);
+                p->y += velocity * delta_t * sin(p->theta);
+                // p->theta += yaw_rate * delta_t; // yaw_rate is zero, so no change to theta
+            }
 
-        // use the prediction equations from the Lesson 14
-        if (fabs(yaw_rate) > 1e-5) {
-            p->x += (velocity / yaw_rate) * (sin(p->theta + yaw_rate * delta_t) - sin(p->theta));
-            p->y += (velocity / yaw_rate) * (cos(p->theta) - cos(p->theta + yaw_rate * delta_t));
-            p->theta += yaw_rate * delta_t;
-        } else {
-            p->x += velocity * delta_t * cos(p->theta);
-            p->y += velocity * delta_t * sin(p->theta);
-            // p->theta += yaw_rate * delta_t; // yaw_rate is zero, so no change to theta
+            // add Gaussian Noise to each measurement
+            p->x += noise_x(chunkGen);
+            p->y += noise_y(chunkGen);
+            p->theta += noise_theta(chunkGen);
         }
-
-        // add Gaussian Noise to each measurement
-        // Normal distribution for x, y and theta
-        normal_distribution<double> dist_x(p->x, std_x);
-        normal_distribution<double> dist_y(p->y, std_y);
-        normal_distribution<double> dist_theta(p->theta, std_theta);
-
-        // update the particle attributes
-        p->x = dist_x(gen);
-        p->y = dist_y(gen);
-        p->theta = dist_theta(gen);
-    }
+    });
 }
 
 void ParticleFilter::dataAssociation(std::vector<LandmarkObs> predicted, std::vector<LandmarkObs>& observations) {
@@ -112,8 +122,92 @@ void ParticleFilter::dataAssociation(std::vector<LandmarkObs> predicted, std::ve
 
 }
 
-void ParticleFilter::updateWeights(double sensor_range, double std_landmark[], std::vector<LandmarkObs> observations,
-                                   Map map_landmarks) {
+/**
+ * @brief Get the likelihood of the observations, as seen from a particle
+ *
+ * @param particle the particle
+ * @param std_x standard deviation of the observations along x
+ * @param std_y standard deviation of the observations along y
+ * @param observations landmark observations, in the robot's coordinate system
+ * @param map_landmarks the map
+ * @return double the weight of the particle
+ */
+static double particleWeight(const Particle& particle, double std_x, double std_y,
+                             const std::vector<LandmarkObs>& observations, const Map& map_landmarks) {
+    const Particle* p = &particle;
+    double wt = 1.0;
+
+    // convert observation from vehicle's to map's coordinate system
+    for (size_t j = 0; j < observations.size(); ++j) {
+        LandmarkObs current_obs = observations[j];
+        LandmarkObs transformed_obs;
+
+        transformed_obs.x = (current_obs.x * cos(p->theta)) - (current_obs.y * sin(p->theta)) + p->x;
+        transformed_obs.y = (current_obs.x * sin(p->theta)) + (current_obs.y * cos(p->theta)) + p->y;
+        transformed_obs.id = current_obs.id;
+
+        // Assume transformed_obs is defined with fields x and y,
+        // and that 'map' is our constant Map instance
+
+        double distance_min = std::numeric_limits<double>::max();
+        Map::single_landmark_s landmark {};
+
+        // Check distance to each landmark (obstacle)
+        for (size_t k = 0; k < map_landmarks.landmark_list.size(); ++k) {
+            Map::single_landmark_s cur_l = map_landmarks.landmark_list[k];
+            double distance = dist(transformed_obs.x, transformed_obs.y, cur_l.x_f, cur_l.y_f);
+            if (distance < distance_min) {
+                distance_min = distance;
+                landmark = cur_l;
+            }
+        }
+
+        // Check distance to the boundaries
+        double d_left = fabs(transformed_obs.x - map_landmarks.min_x);
+        double d_right = fabs(map_landmarks.max_x - transformed_obs.x);
+        double d_bottom = fabs(transformed_obs.y - map_landmarks.min_y);
+        double d_top = fabs(map_landmarks.max_y - transformed_obs.y);
+
+        // Get the minimum boundary distance
+        double boundary_distance = std::min({d_left, d_right, d_bottom, d_top});
+
+        // If the distance to the boundary is smaller, update the minimum distance and landmark info
+        if (boundary_distance < distance_min) {
+            distance_min = boundary_distance;
+
+            // Optionally, create a special "boundary" landmark.
+            // Here, we set id = 0 to indicate a boundary, and we choose the boundary point
+            // that is closest to transformed_obs.
+            if (boundary_distance == d_left) {
+                landmark.x_f = map_landmarks.min_x;
+                landmark.y_f = transformed_obs.y;
+            } else if (boundary_distance == d_right) {
+                landmark.x_f = map_landmarks.max_x;
+                landmark.y_f = transformed_obs.y;
+            } else if (boundary_distance == d_bottom) {
+                landmark.x_f = transformed_obs.x;
+                landmark.y_f = map_landmarks.min_y;
+            } else if (boundary_distance == d_top) {
+                landmark.x_f = transformed_obs.x;
+                landmark.y_f = map_landmarks.max_y;
+            }
+        }
+
+        // Now, distance_min holds the minimum distance to either an obstacle or the boundary,
+        // and 'landmark' holds the corresponding information.
+
+        // update weights using Multivariate Gaussian Distribution
+        // equation given in Transformations and Associations Quiz
+        double num = exp(-0.5 * (pow((transformed_obs.x - landmark.x_f), 2) / pow(std_x, 2) +
+                                 pow((transformed_obs.y - landmark.y_f), 2) / pow(std_y, 2)));
+        double denom = 2 * M_PI * std_x * std_y;
+        wt *= num / denom;
+    }
+    return wt;
+}
+
+void ParticleFilter::updateWeights(double sensor_range, double std_landmark[],
+                                   const std::vector<LandmarkObs>& observations, const Map& map_landmarks) {
     // Update the weights of each particle using a multi-variate Gaussian distribution. You can read
     //   more about this distribution here: https://en.wikipedia.org/wiki/Multivariate_normal_distribution
     // NOTE: The observations are given in the VEHICLE'S coordinate system. Your particles are located
@@ -128,104 +222,117 @@ void ParticleFilter::updateWeights(double sensor_range, double std_landmark[], s
 
     double std_x = std_landmark[0];
     double std_y = std_landmark[1];
-    double weights_sum = 0;
 
-    for (int i = 0; i < num_particles; ++i) {
-        Particle* p = &particles[i];
-        double wt = 1.0;
-
-        // convert observation from vehicle's to map's coordinate system
-        for (int j = 0; j < observations.size(); ++j) {
-            LandmarkObs current_obs = observations[j];
-            LandmarkObs transformed_obs;
-
-            transformed_obs.x = (current_obs.x * cos(p->theta)) - (current_obs.y * sin(p->theta)) + p->x;
-            transformed_obs.y = (current_obs.x * sin(p->theta)) + (current_obs.y * cos(p->theta)) + p->y;
-            transformed_obs.id = current_obs.id;
-
-            // Assume transformed_obs is defined with fields x and y,
-            // and that 'map' is our constant Map instance
-
-            double distance_min = std::numeric_limits<double>::max();
-            Map::single_landmark_s landmark;
-
-            // Check distance to each landmark (obstacle)
-            for (size_t k = 0; k < map_landmarks.landmark_list.size(); ++k) {
-                Map::single_landmark_s cur_l = map_landmarks.landmark_list[k];
-                double distance = dist(transformed_obs.x, transformed_obs.y, cur_l.x_f, cur_l.y_f);
-                if (distance < distance_min) {
-                    distance_min = distance;
-                    landmark = cur_l;
-                }
-            }
+    updateWeights(
+        [&](const Particle& particle) { return particleWeight(particle, std_x, std_y, observations, map_landmarks); },
+        observations.size(), map_landmarks);
+}
 
-            // Check distance to the boundaries
-            double d_left = fabs(transformed_obs.x - map_landmarks.min_x);
-            double d_right = fabs(map_landmarks.max_x - transformed_obs.x);
-            double d_bottom = fabs(transformed_obs.y - map_landmarks.min_y);
-            double d_top = fabs(map_landmarks.max_y - transformed_obs.y);
-
-            // Get the minimum boundary distance
-            double boundary_distance = std::min({d_left, d_right, d_bottom, d_top});
-
-            // If the distance to the boundary is smaller, update the minimum distance and landmark info
-            if (boundary_distance < distance_min) {
-                distance_min = boundary_distance;
-
-                // Optionally, create a special "boundary" landmark.
-                // Here, we set id = 0 to indicate a boundary, and we choose the boundary point
-                // that is closest to transformed_obs.
-                if (boundary_distance == d_left) {
-                    landmark.x_f = map_landmarks.min_x;
-                    landmark.y_f = transformed_obs.y;
-                } else if (boundary_distance == d_right) {
-                    landmark.x_f = map_landmarks.max_x;
-                    landmark.y_f = transformed_obs.y;
-                } else if (boundary_distance == d_bottom) {
-                    landmark.x_f = transformed_obs.x;
-                    landmark.y_f = map_landmarks.min_y;
-                } else if (boundary_distance == d_top) {
-                    landmark.x_f = transformed_obs.x;
-                    landmark.y_f = map_landmarks.max_y;
-                }
+void ParticleFilter::updateWeights(const std::function<double(const Particle&)>& likelihood, int observation_count,
+                                   const Map& map_landmarks) {
+    // weigh every particle, and sum the weights
+    double weights_sum = lemlib::parallelReduce(
+        num_particles, lemlib::DEFAULT_GRAIN, 0.0,
+        [&](size_t begin, size_t end, size_t) {
+            double sum = 0;
+            for (size_t i = begin; i < end; ++i) {
+                particles[i].weight = likelihood(particles[i]);
+                sum += particles[i].weight;
             }
-
-            // Now, distance_min holds the minimum distance to either an obstacle or the boundary,
-            // and 'landmark' holds the corresponding information.
-
-            // update weights using Multivariate Gaussian Distribution
-            // equation given in Transformations and Associations Quiz
-            double num = exp(-0.5 * (pow((transformed_obs.x - landmark.x_f), 2) / pow(std_x, 2) +
-                                     pow((transformed_obs.y - landmark.y_f), 2) / pow(std_y, 2)));
-            double denom = 2 * M_PI * std_x * std_y;
-            wt *= num / denom;
+            return sum;
+        },
+        [](double a, double b) { return a + b; });
+
+    // track how well the particles explain the observations, for augmented MCL. The likelihood is a product over the
+    // observations, so it is compared per observation. Otherwise a sensor going out of range would look like the robot
+    // being lost
+    if (observation_count > 0 && num_particles > 0) {
+        const double w_avg = pow(weights_sum / num_particles, 1.0 / observation_count);
+        if (w_slow <= 0) {
+            w_slow = w_avg;
+            w_fast = w_avg;
+        } else {
+            w_slow += alpha_slow * (w_avg - w_slow);
+            w_fast += alpha_fast * (w_avg - w_fast);
         }
-        weights_sum += wt;
-        p->weight = wt;
     }
+    field_min_x = map_landmarks.min_x;
+    field_max_x = map_landmarks.max_x;
+    field_min_y = map_landmarks.min_y;
+    field_max_y = map_landmarks.max_y;
+
     // normalize weights to bring them in (0, 1]
     if (weights_sum < 1e-10) weights_sum = 1e-10;  // 防止除零
-    for (int i = 0; i < num_particles; i++) {
-        Particle* p = &particles[i];
-        p->weight /= weights_sum;
-        weights[i] = p->weight;
-    }
+    weights.resize(num_particles);
+    lemlib::parallelFor(num_particles, lemlib::DEFAULT_GRAIN, [&](size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; i++) {
+            particles[i].weight /= weights_sum;
+            weights[i] = particles[i].weight;
+        }
+    });
 }
 
 void ParticleFilter::resample() {
     // Resample particles with replacement with probability proportional to their weight.
-    // NOTE: You may find std::discrete_distribution helpful here.
-    //   http://en.cppreference.com/w/cpp/numeric/random/discrete_distribution
-
-
-    // Random integers on the [0, n) range
-    // the probability of each individual integer is its weight of the divided by the sum of all weights.
-    discrete_distribution<int> distribution(weights.begin(), weights.end());
-    vector<Particle> resampled_particles;
+    // Systematic resampling: lay num_particles evenly spaced pointers over the cumulative weights, starting from one
+    // random offset. Each pointer picks the particle whose slice of the cumulative weights it lands in. Compared to
+    // drawing every particle independently this has less variance, and each chunk of pointers can be placed on its
+    // own once the prefix sum is known.
+    if (num_particles == 0) return;
+    cumulative.assign(weights.begin(), weights.end());
+    cumulative.resize(num_particles, 0);
+    lemlib::inclusiveScan(cumulative.data(), num_particles);
+    const double total = cumulative.back();
+    // if every weight is 0 there is nothing to prefer, so keep the particles and leave it to injection
+    if (total > 0) {
+        const double step = total / num_particles;
+        const double start = uniform_real_distribution<double>(0, step)(gen);
+
+        resampled.resize(num_particles);
+        lemlib::parallelFor(num_particles, lemlib::DEFAULT_GRAIN, [&](size_t begin, size_t end, size_t) {
+            // find where this chunk's first pointer lands, then walk forwards since the pointers are in order
+            size_t index =
+                upper_bound(cumulative.begin(), cumulative.end(), start + begin * step) - cumulative.begin();
+            for (size_t i = begin; i < end; i++) {
+                const double pointer = start + i * step;
+                while (index + 1 < cumulative.size() && cumulative[index] <= pointer) index++;
+                resampled[i] = particles[index];
+            }
+        });
 
-    for (int i = 0; i < num_particles; i++) { resampled_particles.push_back(particles[distribution(gen)]); }
+        particles.swap(resampled);
+    }
+    injectRandomParticles();
+}
 
-    particles = resampled_particles;
+void ParticleFilter::injectRandomParticles() {
+    // Augmented MCL: replace particles with random ones in proportion to how far the short term likelihood has
+    // dropped below the threshold, but never more than max_injection of them
+    injected = 0;
+    injection_time = 0;
+    if (!(w_slow > 0) || field_max_x <= field_min_x || field_max_y <= field_min_y) return;
+    const double probability = std::max(0.0, 1.0 - w_fast / (injection_threshold * w_slow));
+    const int count = std::min(static_cast<int>(lround(probability * num_particles)),
+                               static_cast<int>(max_injection * num_particles));
+    if (count <= 0) return;
+
+    const uint64_t start = pros::micros();
+    uniform_real_distribution<double> dist_x(field_min_x, field_max_x);
+    uniform_real_distribution<double> dist_y(field_min_y, field_max_y);
+    normal_distribution<double> noise_theta(0, injection_std_theta);
+    // spread the injected particles evenly over the set. Resampling keeps copies of a particle next to each other, so
+    // this takes particles from every part of the old belief instead of wiping out one cluster
+    const double stride = static_cast<double>(num_particles) / count;
+    for (int i = 0; i < count; ++i) {
+        Particle& p = particles[static_cast<int>(i * stride)];
+        p.x = dist_x(gen);
+        p.y = dist_y(gen);
+        p.theta += noise_theta(gen);
+        // no weight until the next update, so random particles don't drag the pose estimate around
+        p.weight = 0;
+    }
+    injected = count;
+    injection_time = pros::micros() - start;
 }
 
 void ParticleFilter::write(std::string filename) {
@@ -0,0 +1,54 @@
+#include "lemlib/periodicTask.hpp"
+
+namespace lemlib {
+Rate::Rate(uint32_t period)
+    : period(period) {
+    reset();
+}
+
+float Rate::delay() {
+    // skip missed periods instead of trying to catch up on them
+    const uint32_t time = pros::millis();
+    if (time - lastWake > period) lastWake = time - period;
+    pros::Task::delay_until(&lastWake, period);
+    const uint64_t now = pros::micros();
+    const float dt = (now - lastWakeMicros) / 1000000.0;
+    lastWakeMicros = now;
+    return dt;
+}
+
+uint32_t Rate::getPeriod() const { return period; }
+
+void Rate::reset() {
+    lastWake = pros::millis();
+    lastWakeMicros = pros::micros();
+}
+
+PeriodicTask::PeriodicTask(const char* name, uint32_t period, std::function<void(float)> callback)
+    : period(period),
+      callback(std::move(callback)),
+      stats(name, period) {}
+
+PeriodicTask::~PeriodicTask() {
+    if (task) task->remove();
+}
+
+void PeriodicTask::start() {
+    if (task == nullptr) task = std::make_unique<pros::Task>([this] { loop(); });
+}
+
+uint32_t PeriodicTask::getPeriod() const { return period; }
+
+const TaskStats& PeriodicTask::getStats() const { return stats; }
+
+void PeriodicTask::loop() {
+    Rate rate(period);
+    float dt = period / 1000.0;
+    while (true) {
+        stats.beginCycle();
+        callback(dt);
+        stats.endCycle();
+        dt = rate.delay();
+    }
+}
+} // namespace lemlib
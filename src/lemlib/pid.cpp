@@ -1,3 +1,4 @@
+#include <cmath>
 #include "pid.hpp"
 #include "util.hpp"
 
@@ -7,24 +8,83 @@ PID::PID(float kP, float kI, float kD, float windupRange, bool signFlipReset)
       kI(kI),
       kD(kD),
       windupRange(windupRange),
-      signFlipReset(signFlipReset) {}
+      signFlipReset(signFlipReset),
+      minOutput(-INFINITY),
+      maxOutput(INFINITY) {}
+
+float PID::update(const float error) { return update(error, NOMINAL_PERIOD); }
+
+float PID::update(const float error, const float dt) {
+    // like before dt was measured, the first update after a reset takes the derivative from an error of 0
+    const float change = error - prevError;
+    return calculate(error, change, dt, 0);
+}
+
+float PID::update(const float target, const float measurement, const float dt) {
+    const float error = target - measurement;
+    float change;
+    if (firstUpdate) change = 0;
+    // a rising measurement is a falling error
+    else if (derivativeOnMeasurement) change = prevMeasurement - measurement;
+    else change = error - prevError;
+    prevMeasurement = measurement;
+    return calculate(error, change, dt, feedforward ? feedforward(target, measurement) : 0);
+}
+
+float PID::calculate(const float error, const float change, float dt, const float feedforward) {
+    firstUpdate = false;
+    if (dt <= 0) dt = NOMINAL_PERIOD;
+    // how many nominal periods have passed, which the gains are in terms of
+    const float periods = dt / NOMINAL_PERIOD;
 
-float PID::update(const float error) {
     // calculate integral
-    integral += error;
-    if (sgn(error) != sgn((prevError)) && signFlipReset) integral = 0;
-    if (fabs(error) > windupRange && windupRange != 0) integral = 0;
+    const float step = error * periods * kI;
+    integral += step;
+    bool integralReset = false;
+    if (sgn(error) != sgn((prevError)) && signFlipReset) integralReset = true;
+    if (fabs(error) > windupRange && windupRange != 0) integralReset = true;
+    if (integralReset) integral = 0;
 
-    // calculate derivative
-    const float derivative = error - prevError;
+    // calculate derivative, low pass filtered if enabled
+    const float rawDerivative = change / periods;
+    if (derivativeTimeConstant > 0) derivative += (rawDerivative - derivative) * dt / (derivativeTimeConstant + dt);
+    else derivative = rawDerivative;
     prevError = error;
 
     // calculate output
-    return error * kP + integral * kI + derivative * kD;
+    const float output = error * kP + integral + derivative * kD + feedforward;
+    // don't let the integral grow further while the output is saturated in the same direction
+    if (!integralReset && ((output > maxOutput && error > 0) || (output < minOutput && error < 0))) integral -= step;
+    const float limited = error * kP + integral + derivative * kD + feedforward;
+    return std::fmax(minOutput, std::fmin(limited, maxOutput));
+}
+
+void PID::setGains(PIDGains gains) {
+    kP = gains.kP;
+    kI = gains.kI;
+    kD = gains.kD;
+}
+
+PIDGains PID::getGains() const { return {kP, kI, kD}; }
+
+void PID::setOutputLimits(float min, float max) {
+    minOutput = std::fmin(min, max);
+    maxOutput = std::fmax(min, max);
+}
+
+void PID::setDerivativeFilter(float timeConstant) { derivativeTimeConstant = std::fmax(timeConstant, 0.0f); }
+
+void PID::setDerivativeOnMeasurement(bool onMeasurement) { derivativeOnMeasurement = onMeasurement; }
+
+void PID::setFeedforward(std::function<float(float target, float measurement)> feedforward) {
+    this->feedforward = std::move(feedforward);
 }
 
 void PID::reset() {
     integral = 0;
     prevError = 0;
+    prevMeasurement = 0;
+    derivative = 0;
+    firstUpdate = true;
 }
-} // namespace lemlib
\ No newline at end of file
+} // namespace lemlib
@@ -0,0 +1,208 @@
+#include "pros/rtos.hpp"
+#include "lemlib/taskStats.hpp"
+#include "lemlib/logger/logger.hpp"
+#include "lemlib/logger/stdout.hpp"
+
+namespace lemlib {
+/**
+ * @brief the maximum number of tasks that can be registered at once
+ */
+constexpr int MAX_TASKS = 24;
+
+/**
+ * @brief registry of every TaskStats that currently exists
+ *
+ * Only used when tasks are created, destroyed, or reported on, so a mutex is fine here
+ */
+struct TaskRegistry {
+        pros::Mutex mutex;
+        std::array<TaskStats*, MAX_TASKS> tasks {};
+};
+
+static TaskRegistry& taskRegistry() {
+    static TaskRegistry registry;
+    return registry;
+}
+
+// each histogram only has one writer, so a relaxed load followed by a store is enough to keep it lock-free
+template <typename T> static void increment(std::atomic<T>& value, uint32_t amount = 1) {
+    value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+TimingHistogram::TimingHistogram(uint32_t bucketWidth)
+    : bucketWidth(bucketWidth > 0 ? bucketWidth : 1) {
+    clear();
+}
+
+void TimingHistogram::record(uint32_t time) {
+    if (resetPending.load(std::memory_order_relaxed)) {
+        clear();
+        resetPending.store(false, std::memory_order_relaxed);
+    }
+    const uint32_t bucket = time / bucketWidth;
+    increment(buckets[bucket < BUCKETS ? bucket : BUCKETS - 1]);
+    increment(count);
+    increment(sum, time);
+    if (time < min.load(std::memory_order_relaxed)) min.store(time, std::memory_order_relaxed);
+    if (time > max.load(std::memory_order_relaxed)) max.store(time, std::memory_order_relaxed);
+}
+
+uint32_t TimingHistogram::getBucket(int bucket) const {
+    if (bucket < 0 || bucket >= BUCKETS) return 0;
+    return buckets[bucket].load(std::memory_order_relaxed);
+}
+
+uint32_t TimingHistogram::getBucketWidth() const { return bucketWidth; }
+
+uint32_t TimingHistogram::getCount() const { return count.load(std::memory_order_relaxed); }
+
+uint32_t TimingHistogram::getMin() const {
+    const uint32_t value = min.load(std::memory_order_relaxed);
+    return value == UINT32_MAX ? 0 : value;
+}
+
+uint32_t TimingHistogram::getMax() const { return max.load(std::memory_order_relaxed); }
+
+float TimingHistogram::getMean() const {
+    const uint32_t samples = getCount();
+    if (samples == 0) return 0;
+    return float(sum.load(std::memory_order_relaxed)) / samples;
+}
+
+uint32_t TimingHistogram::getPercentile(float percentile) const {
+    const uint32_t samples = getCount();
+    if (samples == 0) return 0;
+    const uint32_t target = percentile * samples;
+    uint32_t seen = 0;
+    for (int i = 0; i < BUCKETS - 1; i++) {
+        seen += getBucket(i);
+        if (seen > target) return (i + 1) * bucketWidth;
+    }
+    // the sample is in the overflow bucket, so the best we can do is the largest sample
+    return getMax();
+}
+
+void TimingHistogram::reset() { resetPending.store(true, std::memory_order_relaxed); }
+
+void TimingHistogram::clear() {
+    for (std::atomic<uint32_t>& bucket : buckets) bucket.store(0, std::memory_order_relaxed);
+    count.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    min.store(UINT32_MAX, std::memory_order_relaxed);
+    max.store(0, std::memory_order_relaxed);
+}
+
+TaskStats::TaskStats(const char* name, uint32_t period)
+    : name(name),
+      period(period),
+      // period and execution time buckets cover up to twice the period, jitter buckets cover up to the period
+      periodHistogram(period * 1000 / 8),
+      jitterHistogram(period * 1000 / 16),
+      executionHistogram(period * 1000 / 8) {
+    TaskRegistry& registry = taskRegistry();
+    registry.mutex.take();
+    for (TaskStats*& task : registry.tasks) {
+        if (task == nullptr) {
+            task = this;
+            break;
+        }
+    }
+    registry.mutex.give();
+}
+
+TaskStats::~TaskStats() {
+    TaskRegistry& registry = taskRegistry();
+    registry.mutex.take();
+    for (TaskStats*& task : registry.tasks) {
+        if (task == this) task = nullptr;
+    }
+    registry.mutex.give();
+}
+
+void TaskStats::beginCycle() {
+    if (resetPending.load(std::memory_order_relaxed)) {
+        cycles.store(0, std::memory_order_relaxed);
+        overruns.store(0, std::memory_order_relaxed);
+        prevCycleStart = 0;
+        resetPending.store(false, std::memory_order_relaxed);
+    }
+    cycleStart = pros::micros();
+    if (prevCycleStart != 0) {
+        const uint32_t actualPeriod = cycleStart - prevCycleStart;
+        const int32_t jitter = int32_t(actualPeriod) - int32_t(getPeriod() * 1000);
+        periodHistogram.record(actualPeriod);
+        jitterHistogram.record(jitter < 0 ? -jitter : jitter);
+    }
+    prevCycleStart = cycleStart;
+}
+
+void TaskStats::endCycle() {
+    const uint32_t executionTime = pros::micros() - cycleStart;
+    executionHistogram.record(executionTime);
+    increment(cycles);
+    if (executionTime > getPeriod() * 1000) increment(overruns);
+}
+
+void TaskStats::setPeriod(uint32_t period) { this->period.store(period, std::memory_order_relaxed); }
+
+uint32_t TaskStats::getPeriod() const { return period.load(std::memory_order_relaxed); }
+
+const char* TaskStats::getName() const { return name; }
+
+uint32_t TaskStats::getCycles() const { return cycles.load(std::memory_order_relaxed); }
+
+uint32_t TaskStats::getOverruns() const { return overruns.load(std::memory_order_relaxed); }
+
+const TimingHistogram& TaskStats::getPeriodHistogram() const { return periodHistogram; }
+
+const TimingHistogram& TaskStats::getJitterHistogram() const { return jitterHistogram; }
+
+const TimingHistogram& TaskStats::getExecutionHistogram() const { return executionHistogram; }
+
+void TaskStats::reset() {
+    periodHistogram.reset();
+    jitterHistogram.reset();
+    executionHistogram.reset();
+    resetPending.store(true, std::memory_order_relaxed);
+}
+
+ScopedTimer::ScopedTimer(TaskStats& stats)
+    : stats(stats) {
+    stats.beginCycle();
+}
+
+ScopedTimer::~ScopedTimer() { stats.endCycle(); }
+
+void printTimingReport() {
+    TaskRegistry& registry = taskRegistry();
+    registry.mutex.take();
+    bufferedStdout().print("{:<16}{:>8}{:>9}{:>11}{:>11}{:>11}{:>11}{:>11}{:>11}\n", "task", "cycles", "overruns",
+                           "period", "period max", "jitter p99", "exec", "exec p99", "exec max");
+    for (TaskStats* task : registry.tasks) {
+        if (task == nullptr) continue;
+        const TimingHistogram& period = task->getPeriodHistogram();
+        const TimingHistogram& jitter = task->getJitterHistogram();
+        const TimingHistogram& execution = task->getExecutionHistogram();
+        bufferedStdout().print("{:<16}{:>8}{:>9}{:>11.0f}{:>11}{:>11}{:>11.0f}{:>11}{:>11}\n", task->getName(),
+                               task->getCycles(), task->getOverruns(), period.getMean(), period.getMax(),
+                               jitter.getPercentile(0.99), execution.getMean(), execution.getPercentile(0.99),
+                               execution.getMax());
+    }
+    registry.mutex.give();
+}
+
+void logTimingTelemetry() {
+    TaskRegistry& registry = taskRegistry();
+    registry.mutex.take();
+    for (TaskStats* task : registry.tasks) {
+        if (task == nullptr) continue;
+        const TimingHistogram& period = task->getPeriodHistogram();
+        const TimingHistogram& jitter = task->getJitterHistogram();
+        const TimingHistogram& execution = task->getExecutionHistogram();
+        telemetrySink()->info("TIMING,{},{},{},{:.0f},{},{},{:.0f},{},{}", task->getName(), task->getCycles(),
+                              task->getOverruns(), period.getMean(), period.getMax(), jitter.getPercentile(0.99),
+                              execution.getMean(), execution.getPercentile(0.99), execution.getMax());
+    }
+    registry.mutex.give();
+}
+} // namespace lemlib
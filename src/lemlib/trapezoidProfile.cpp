@@ -0,0 +1,55 @@
+#include <cmath>
+#include "lemlib/trapezoidProfile.hpp"
+#include "lemlib/util.hpp"
+
+namespace lemlib {
+TrapezoidProfile::TrapezoidProfile(float maxVelocity, float maxAcceleration)
+    : maxVelocity(std::fabs(maxVelocity)),
+      maxAcceleration(std::fabs(maxAcceleration)) {}
+
+void TrapezoidProfile::reset(float position, float velocity) {
+    this->position = position;
+    this->velocity = velocity;
+    acceleration = 0;
+    goal = position;
+}
+
+void TrapezoidProfile::setGoal(float goal) { this->goal = goal; }
+
+void TrapezoidProfile::setMaxVelocity(float maxVelocity) { this->maxVelocity = std::fabs(maxVelocity); }
+
+void TrapezoidProfile::update(float dt) {
+    if (dt <= 0) return;
+    const float error = goal - position;
+    // the fastest the setpoint can go through this step and still stop at the goal, which is what makes the profile
+    // decelerate. Solves v * dt + v^2 / 2a = error for v
+    const float stepAcceleration = maxAcceleration * dt;
+    const float stoppable =
+        std::sqrt(stepAcceleration * stepAcceleration + 2 * maxAcceleration * std::fabs(error)) - stepAcceleration;
+    const float target = sgn(error) * std::fmin(maxVelocity, stoppable);
+    const float change = std::fmax(-stepAcceleration, std::fmin(target - velocity, stepAcceleration));
+    const float prevVelocity = velocity;
+    velocity += change;
+    acceleration = change / dt;
+    position += (prevVelocity + velocity) / 2 * dt;
+
+    // stop at the goal once the setpoint reaches it slowly enough to stop within a step, rather than overshooting it
+    // by a sliver and oscillating around it
+    const float remaining = goal - position;
+    if ((remaining == 0 || sgn(remaining) != sgn(error)) && std::fabs(velocity) <= stepAcceleration * 2) {
+        position = goal;
+        velocity = 0;
+        acceleration = 0;
+    }
+}
+
+float TrapezoidProfile::getPosition() const { return position; }
+
+float TrapezoidProfile::getVelocity() const { return velocity; }
+
+float TrapezoidProfile::getAcceleration() const { return acceleration; }
+
+float TrapezoidProfile::getGoal() const { return goal; }
+
+bool TrapezoidProfile::isDone() const { return position == goal && velocity == 0; }
+} // namespace lemlib
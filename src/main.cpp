@@ -8,6 +8,9 @@
 
 Map map_landmarks; 
 ParticleTask particleTask(chassis, map_landmarks);
+// the distance each distance sensor should read at every pose, generated by `make range-table`
+ASSET(rangeTable_bin);
+lemlib::RangeTable rangeTable;
 /**
  * Runs initialization code. This occurs as soon as the program is started.
  *
@@ -15,7 +18,15 @@ ParticleTask particleTask(chassis, map_landmarks);
  * to keep execution time for this mode under a few seconds.
  */
 void initialize() {
+    subsystemScheduler().start(); // run the subsystems, now that they have all been constructed
+    lemlib::telemetrySink()->setLowestLevel(lemlib::Level::INFO); // telemetry is sent at INFO, so let it through
+    lemlib::setOdomPeriod(5); // the rotation sensors and IMU can report every 5ms
     chassis.calibrate(); // calibrate sensors
+    chassis.setAngularGainSchedule(&angularSchedule);
+    chassis.setTurnProfile(turnProfile);
+    // weigh the particle filter with a beam model. The table only fits the mounts it was generated for
+    if (!rangeTable.load(rangeTable_bin) || !lemlib::setRangeTable(&rangeTable))
+        std::cout << "range table doesn't match the distance sensors, run make range-table" << std::endl;
     conveyor.getOpticalSensor()->set_led_pwm(100);
     
     double initial_x = chassis.getPose().x;
@@ -40,13 +51,23 @@ void initialize() {
     // thread to for brain screen and position logging
     if(autonSelector == false){
         pros::Task screenTask   ([&]() {
+            static lemlib::TaskStats screenStats("screen", 50);
+            lemlib::Rate rate(50);
+            uint32_t lastTimingTelemetry = pros::millis();
             while (true) {
+                screenStats.beginCycle();
+                // send how long each task takes, so overruns show up in the terminal log
+                if (pros::millis() - lastTimingTelemetry >= TIMING_TELEMETRY_PERIOD) {
+                    lemlib::logTimingTelemetry();
+                    lastTimingTelemetry = pros::millis();
+                }
                 pros::screen::erase();
                 // print robot location to the brain screen
                 pros::screen::print(pros::text_format_e_t::E_TEXT_MEDIUM_CENTER, 0, "X: %f, Y: %f, Theta: %f",
                                     chassis.getPose().x, chassis.getPose().y, chassis.getPose().theta); // x
+                screenStats.endCycle();
 
-                pros::delay(50);
+                rate.delay();
             }
         });
     }
@@ -55,7 +76,7 @@ void initialize() {
 /**
  * Runs while the robot is disabled
  */
-void disabled() {}
+void disabled() { lemlib::stopSensorLog(); }
 
 /**
  * runs after initialize if the robot is connected to field control
@@ -66,6 +87,57 @@ void competition_initialize() {}
 // this needs to be put outside a function
 ASSET(example_txt); // '.' replaced with "_" to make c++ happy
 
+/**
+ * Runs the characterization tests on the drivetrain, turning and the arm, one after the other. They are logged through
+ * the telemetry sink: save the terminal output and fit it with make characterize, then bin/host/characterize log.txt
+ *
+ * The drivetrain drives up to CHARACTERIZE_DRIVE_TRAVEL forwards and back, and turns in place, so it needs room. The
+ * arm should start down
+ */
+void characterize() {
+    chassis.cancelAllMotions();
+    chassis.setBrakeMode(pros::E_MOTOR_BRAKE_COAST);
+    // distance along the heading the robot starts at, so driving slightly off straight isn't counted
+    const lemlib::Pose start = chassis.getPose(true);
+    lemlib::Characterization drive(
+        "drive",
+        [](float power) {
+            leftMotors.move(power);
+            rightMotors.move(power);
+        },
+        [start] {
+            const lemlib::Pose pose = chassis.getPose(true);
+            return (pose.x - start.x) * std::sin(start.theta) + (pose.y - start.y) * std::cos(start.theta);
+        });
+    lemlib::Characterization turn(
+        "turn",
+        [](float power) {
+            leftMotors.move(power);
+            rightMotors.move(-power);
+        },
+        [] { return chassis.getPose().theta; });
+    // the arm's angle from horizontal, so the fit can tell how much of the power holds it up
+    lemlib::Characterization armTest("arm", [](float power) { arm.setTestPower(power); },
+                                     [] { return arm.getRotation()->get_position() / 100.0 - ARM_HORIZONTAL_DEGREES; });
+
+    // each pair of tests goes out and comes back, so the mechanism ends where it started
+    auto runTests = [](lemlib::Characterization& mechanism, float step, float travel) {
+        using lemlib::CharacterizationTest;
+        mechanism.run(CharacterizationTest::QUASISTATIC, true, CHARACTERIZE_RAMP, CHARACTERIZE_TIMEOUT, travel);
+        pros::delay(CHARACTERIZE_REST);
+        mechanism.run(CharacterizationTest::QUASISTATIC, false, CHARACTERIZE_RAMP, CHARACTERIZE_TIMEOUT, travel);
+        pros::delay(CHARACTERIZE_REST);
+        mechanism.run(CharacterizationTest::DYNAMIC, true, step, CHARACTERIZE_TIMEOUT, travel);
+        pros::delay(CHARACTERIZE_REST);
+        mechanism.run(CharacterizationTest::DYNAMIC, false, step, CHARACTERIZE_TIMEOUT, travel);
+        pros::delay(CHARACTERIZE_REST);
+    };
+    runTests(drive, CHARACTERIZE_STEP, CHARACTERIZE_DRIVE_TRAVEL);
+    runTests(turn, CHARACTERIZE_STEP, INFINITY);
+    runTests(armTest, CHARACTERIZE_ARM_STEP, CHARACTERIZE_ARM_TRAVEL);
+    arm.moveToState(ArmNamespace::State::DOWN);
+}
+
 /**
  * Runs during auto
  *
@@ -74,23 +146,14 @@ ASSET(example_txt); // '.' replaced with "_" to make c++ happy
 
 void autonomous() {
     // skills();
- 
-    if (withAntiJam) {
-        pros::Task antiJam([&]() {
-            while (withAntiJam) {
-                if (conveyor.getIntake()->getMotor()->get_actual_velocity() > 100 && conveyor.getHood()->getMotor()->get_actual_velocity() < 50 && conveyor.getHood()->getMotor()->get_current_draw() > 1500) {
-                    ConveyorNamespace::State curState = conveyor.getState();
-                    conveyor.moveToState(ConveyorNamespace::State::OUTTAKE);
-                    pros::delay(100);
-                    conveyor.moveToState(curState);
-                }
-                pros::delay(20);
-            }
-            pros::delay(20);
-        });
+    if (RUN_CHARACTERIZATION) {
+        characterize();
+        return;
     }
-
-
+    // stopped when auton ends, in disabled() or opcontrol()
+    if (RECORD_SENSOR_LOG && !lemlib::startSensorLog(SENSOR_LOG_PATH))
+        std::cout << "couldn't open " << SENSOR_LOG_PATH << ", is there an SD card?" << std::endl;
+ 
     if (autonSelector) {
         if (RUN_SKILLS) skills(); 
         else selector.run_auton();
@@ -112,10 +175,12 @@ void autonomous() {
  * Runs in driver control
  */
 void opcontrol() {
+    lemlib::stopSensorLog();
     chassis.setBrakeMode(pros::E_MOTOR_BRAKE_COAST);
     lemlib::Timer timer(15000);
     conveyor.disable_color_sensor();
     deadwheel_lifter.moveToState(HolderNamespace::State::HOLD);
+    lemlib::Rate rate(10);
     // controller
     // loop to continuously update motors
     while (true) {
@@ -149,7 +214,7 @@ void opcontrol() {
         goal_transfer.control(buttonR1, false);
         Lipper.control(buttonY, true);
         Descore.control(buttonDown,true);
-        // Delay to save resources
-        pros::delay(10);
+        // Wait for the next 10ms period
+        rate.delay();
     }
 }
\ No newline at end of file
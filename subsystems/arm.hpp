@@ -1,59 +1,70 @@
 #pragma once
 
 #include "pros/motor_group.hpp"
+#include <cmath>
 #include "lemlib/api.hpp"
+#include "cachedDevice.hpp"
+#include "stateMachine.hpp"
 #include "subsystem.hpp"
 
 namespace ArmNamespace {
 
-enum class State { DOWN, WAIT, UP, VERTICAL_UP, DESCORE_UP, SCORE_UP, AUTO_UP, IDLE };
+// TEST gives the arm a fixed power, for characterization
+enum class State { DOWN, WAIT, UP, VERTICAL_UP, DESCORE_UP, SCORE_UP, AUTO_UP, IDLE, TEST };
 
 class Arm : public subsystem<State> {
     public:
         Arm(std::shared_ptr<pros::Motor> motor, std::shared_ptr<pros::Rotation> rotation,
             lemlib::ControllerSettings armAngularController, lemlib::ControllerSettings armAngularControllerSmallAngle)
-            : motor_(std::move(motor)),
+            : subsystem("arm"),
+              motor_(std::move(motor)),
               rotation_(std::move(rotation)),
+              output_(motor_),
               armAngularPID(armAngularController.kP, armAngularController.kI, armAngularController.kD,
                             armAngularController.windupRange, true),
               armAngularPIDSmallAngle(armAngularControllerSmallAngle.kP, armAngularControllerSmallAngle.kI,
                             armAngularControllerSmallAngle.kD, armAngularControllerSmallAngle.windupRange, true) {
             motor_->set_encoder_units(pros::E_MOTOR_ENCODER_DEGREES);
             motor_->tare_position();
-            motor_->set_brake_mode(pros::MotorBrake::hold);
+            output_.setBrakeMode(pros::MotorBrake::hold);
             rotation_->set_position(0);
             rotation_->reset();
+            for (lemlib::PID* pid : {&armAngularPID, &armAngularPIDSmallAngle}) {
+                // the PIDs correct what the feedforward misses, and stop integrating once the motor is saturated
+                pid->setOutputLimits(-127, 127);
+                pid->setDerivativeFilter(ARM_DERIVATIVE_FILTER);
+                // the target moves along the profile, so damp the error rather than all motion
+                pid->setDerivativeOnMeasurement(false);
+                pid->setFeedforward([this](float, float angle) {
+                    return feedforward(angle, profile_.getVelocity(), profile_.getAcceleration());
+                });
+            }
         }
 
         ~Arm() override = default;
 
         // Controls the arm based on button inputs
         void control(bool button_1, bool button_2, bool button_3, bool button_4) { // R2 Y Right UP
-            
+            // keep the scheduler from running the arm between reading and changing its state
+            std::lock_guard lock(subsystemScheduler().getMutex());
             if (button_1) {
-                motor_->set_brake_mode(pros::MotorBrake::hold);
                 moveToState(State::UP);
             }  else if (currState == State::UP) {
                 moveToState(State::DOWN);
             }  
 
             if (button_2 && currState == State::DOWN) {
-                motor_->set_brake_mode(pros::MotorBrake::hold);
                 moveToState(State::WAIT);
             } else if (button_2 && (currState == State::WAIT || currState == State::VERTICAL_UP)) {
-                motor_->set_brake_mode(pros::MotorBrake::hold);
                 moveToState(State::SCORE_UP);
             } else if (button_2 && currState == State::SCORE_UP) {
-                motor_->set_brake_mode(pros::MotorBrake::hold);
                 moveToState(State::DOWN);
             }
 
             if (button_3) {
-                motor_->set_brake_mode(pros::MotorBrake::hold);
                 moveToState(State::VERTICAL_UP);
             }
             if (button_4) {
-                motor_->set_brake_mode(pros::MotorBrake::hold);
                 moveToState(State::DESCORE_UP);
             }
             
@@ -76,100 +87,138 @@ class Arm : public subsystem<State> {
                 case State::DOWN: return "DOWN";
                 case State::VERTICAL_UP: return "VERTICAL_UP";
                 case State::SCORE_UP: return "SCORE_UP";
+                case State::TEST: return "TEST";
                 default: return "UNKNOWN";
             }
         }
 
-        void moveToState(State newState) {
-            armAngularPID.reset();
-            armAngularPIDSmallAngle.reset();
-            currState = newState;
-        }
+        void resetRotation(float rotation) { rotation_->set_position(rotation); }
 
-        void moveToState(State newState, int time) {
-            timer.set(time);
-            moveToState(newState);
+        // Give the arm a fixed power, from -127 to 127, until it is moved to another state
+        void setTestPower(float power) {
+            std::lock_guard lock(subsystemScheduler().getMutex());
+            testPower_ = power;
+            moveToState(State::TEST);
         }
 
-        void resetRotation(float rotation) { rotation_->set_position(rotation); }
+        // How many motor commands were sent, and how many were skipped because they hadn't changed
+        const DeviceWrites& getWrites() const { return output_.getWrites(); }
     private:
         std::shared_ptr<pros::Motor> motor_;
         std::shared_ptr<pros::Rotation> rotation_;
+        CachedMotor output_; // Commands motor_, skipping ones that haven't changed
         float ratio_ = 1;
         bool manual_;
+
+        // the setpoint the arm follows to the position of its state, in degrees
+        lemlib::TrapezoidProfile profile_ {ARM_MAX_VELOCITY, ARM_MAX_ACCELERATION};
+        uint32_t lastDrive_ = 0;
+        bool holding_ = false; // whether the profile has reached its goal and the arm is holding there
+        float testPower_ = 0;
+
+        float getAngle() const { return rotation_->get_position() / 100.0; }
+
+        // position of each state, in degrees. IDLE and TEST don't have one
+        static float getTarget(State state) {
+            switch (state) {
+                case State::DOWN: return DOWN_DEGREES / 100;
+                case State::WAIT: return WAIT_DEGREES / 100;
+                case State::UP: return MAX_DEGREES / 100;
+                case State::VERTICAL_UP: return VERTICAL_DEGREES / 100;
+                case State::DESCORE_UP: return DESCORE_DEGREES / 100;
+                case State::SCORE_UP: return SCORE_DEGREES / 100;
+                case State::AUTO_UP: return AUTO_DEGREES / 100;
+                case State::IDLE:
+                case State::TEST: return NAN;
+            }
+            return NAN;
+        }
+
+        // power the arm needs to follow the setpoint, from its dynamics. The PID only has to correct what this misses
+        static float feedforward(float angle, float velocity, float acceleration) {
+            const float friction = velocity > 0 ? ARM_KS : velocity < 0 ? -ARM_KS : 0;
+            return ARM_KG * std::cos(lemlib::degToRad(angle - ARM_HORIZONTAL_DEGREES)) + friction + ARM_KV * velocity +
+                   ARM_KA * acceleration;
+        }
     protected:
         lemlib::Timer delay_timer {20};
 
         // angular motion controller
         lemlib::PID armAngularPID, armAngularPIDSmallAngle;
 
-        // Task to control the arm's movement
-        void runTask() override final {
-            if (currState == State::DOWN) motor_->set_brake_mode(pros::MotorBrake::coast);
-            else motor_->set_brake_mode(pros::MotorBrake::hold);
+        // The arm holds its position in every state but DOWN, where it rests on the hard stop. Each state starts a
+        // new profile from where the arm is, keeping the setpoint's velocity so the arm can be redirected mid move
+        void enterCoast() {
+            startProfile();
+            output_.setBrakeMode(pros::MotorBrake::coast);
+        }
 
-            switch (currState) {
-                case State::UP:
-                    if (rotation_->get_position() <= MAX_DEGREES) {
-                        motor_->move(127 * ratio_);
-                    } else {
-                        motor_->move(0);
-                    }
-                    break;
-                case State::WAIT:
-                    if (float angularError = (WAIT_DEGREES - rotation_->get_position()) / 100.0;
-                        abs(angularError) > 2) {
-                        if (angularError < WAIT_DEGREES * 0) {
-                            motor_->move(armAngularPIDSmallAngle.update(angularError));
-                        } else {
-                            motor_->move(armAngularPID.update(angularError));
-                        }
-                        //motor_->move(armAngularPIDSmallAngle.update(angularError));
-                    } else {
-                        motor_->move(0);
-                    }
-                    break;
-                case State::DOWN:
-                    if (rotation_->get_position() > DOWN_DEGREES) {
-                        motor_->move(-127 * ratio_);
-                    } else {
-                        motor_->move(0);
-                    }
-                    break;
-                case State::VERTICAL_UP:
-                    if (float angularError = (VERTICAL_DEGREES - rotation_->get_position()) / 100.0;
-                    abs(angularError) > 2) {
-                        motor_->move(armAngularPID.update(angularError));
-                    } else {
-                        motor_->move(0);
-                    }
-                break;
-                case State::DESCORE_UP:
-                    if (float angularError = (DESCORE_DEGREES - rotation_->get_position()) / 100.0;
-                    abs(angularError) > 2) {
-                        motor_->move(armAngularPID.update(angularError));
-                    } else {
-                        motor_->move(0);
-                    }
-                break;
-                case State::SCORE_UP:
-                    if (float angularError = (SCORE_DEGREES - rotation_->get_position()) / 100.0;
-                        abs(angularError) > 2) {
-                        motor_->move(armAngularPID.update(angularError));
-                    } else {
-                        motor_->move(0);
-                    }
-                    break;
-                case State::AUTO_UP:
-                    if (float angularError = (AUTO_DEGREES - rotation_->get_position()) / 100.0;
-                        abs(angularError) > 2) {
-                        motor_->move(armAngularPID.update(angularError));
-                    } else {
-                        motor_->move(0);
-                    }
-                    break;
-                case State::IDLE: motor_->move(0); break;
+        void enterHold() {
+            startProfile();
+            output_.setBrakeMode(pros::MotorBrake::hold);
+        }
+
+        void startProfile() {
+            armAngularPID.reset();
+            armAngularPIDSmallAngle.reset();
+            holding_ = false;
+            lastDrive_ = pros::millis();
+            const float target = getTarget(currState);
+            profile_.reset(getAngle(), profile_.getVelocity());
+            profile_.setMaxVelocity(ARM_MAX_VELOCITY * ratio_);
+            if (!std::isnan(target)) profile_.setGoal(target);
+        }
+
+        // Drive the arm along the profile to the position of the current state, and hold it there
+        void drive() {
+            if (currState == State::IDLE) {
+                // the arm is free, so the next move starts from wherever it ends up, at rest
+                profile_.reset(getAngle());
+                output_.move(0);
+                return;
             }
+            if (currState == State::TEST) {
+                profile_.reset(getAngle());
+                output_.move(testPower_);
+                return;
+            }
+            const uint32_t now = pros::millis();
+            const float dt = (now - lastDrive_) / 1000.0;
+            profile_.update(dt);
+            lastDrive_ = now;
+
+            // at the bottom the arm rests on the hard stop, so there is nothing to hold
+            if (currState == State::DOWN && profile_.isDone()) {
+                output_.move(0);
+                return;
+            }
+            // a separate controller holds the arm once it gets there, starting without the derivative of the move
+            if (profile_.isDone() && !holding_) {
+                holding_ = true;
+                armAngularPIDSmallAngle.reset();
+            }
+            lemlib::PID& pid = holding_ ? armAngularPIDSmallAngle : armAngularPID;
+            output_.move(pid.update(profile_.getPosition(), getAngle(), dt));
         }
+
+        // state, parent, entry, exit, during
+        static constexpr std::array<StateDef<State, Arm>, 9> STATES {{
+            {State::DOWN, State::DOWN, &Arm::enterCoast, nullptr, &Arm::drive},
+            {State::WAIT, State::WAIT, &Arm::enterHold, nullptr, &Arm::drive},
+            {State::UP, State::UP, &Arm::enterHold, nullptr, &Arm::drive},
+            {State::VERTICAL_UP, State::VERTICAL_UP, &Arm::enterHold, nullptr, &Arm::drive},
+            {State::DESCORE_UP, State::DESCORE_UP, &Arm::enterHold, nullptr, &Arm::drive},
+            {State::SCORE_UP, State::SCORE_UP, &Arm::enterHold, nullptr, &Arm::drive},
+            {State::AUTO_UP, State::AUTO_UP, &Arm::enterHold, nullptr, &Arm::drive},
+            {State::IDLE, State::IDLE, &Arm::enterHold, nullptr, &Arm::drive},
+            {State::TEST, State::TEST, &Arm::enterCoast, nullptr, &Arm::drive},
+        }};
+        // the arm only changes state when told to
+        static constexpr std::array<Transition<State, Arm>, 0> TRANSITIONS {};
+
+        StateMachine<State, Arm, STATES.size(), TRANSITIONS.size()> machine_ {STATES, TRANSITIONS};
+
+        // Task to control the arm's movement
+        void runTask() override final { machine_.tick(*this, currState); }
 };
 } // namespace ArmNamespace
\ No newline at end of file
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include "pros/adi.hpp"
+#include "pros/motors.hpp"
+#include "pros/rtos.hpp"
+#include "constants.hpp"
+
+// Subsystems set their outputs every tick, but a command only has to reach the device when it changes. These wrap a
+// device and remember the last command sent to it, so repeating it doesn't use the smart port or ADI bus. The last
+// command is still resent every refreshTime ms, in case the device missed it, e.g. after being unplugged.
+
+// Counts how many commands were sent to a device, and how many were skipped
+struct DeviceWrites {
+        uint32_t sent = 0;
+        uint32_t skipped = 0;
+};
+
+class CachedMotor {
+    public:
+        explicit CachedMotor(std::shared_ptr<pros::Motor> motor, uint32_t refreshTime = DEVICE_REFRESH_TIME)
+            : motor_(std::move(motor)),
+              refreshTime_(refreshTime) {}
+
+        // Voltage from -127 to 127, like pros::Motor::move
+        void move(int32_t voltage) {
+            if (isCached(Command::VOLTAGE, voltage)) return;
+            motor_->move(voltage);
+            sent(Command::VOLTAGE, voltage);
+        }
+
+        // Velocity in rpm, like pros::Motor::move_velocity
+        void moveVelocity(int32_t velocity) {
+            if (isCached(Command::VELOCITY, velocity)) return;
+            motor_->move_velocity(velocity);
+            sent(Command::VELOCITY, velocity);
+        }
+
+        // Brake modes aren't lost when the motor is unplugged, so they are only sent when they change
+        void setBrakeMode(pros::MotorBrake mode) {
+            if (brakeModeSet_ && mode == brakeMode_) {
+                writes_.skipped++;
+                return;
+            }
+            motor_->set_brake_mode(mode);
+            brakeMode_ = mode;
+            brakeModeSet_ = true;
+            writes_.sent++;
+        }
+
+        // Forget the last command, so the next one is always sent. Needed after commanding the motor directly
+        void invalidate() {
+            command_ = Command::NONE;
+            brakeModeSet_ = false;
+        }
+
+        const DeviceWrites& getWrites() const { return writes_; }
+
+        std::shared_ptr<pros::Motor> getMotor() const { return motor_; }
+    private:
+        enum class Command { NONE, VOLTAGE, VELOCITY };
+
+        std::shared_ptr<pros::Motor> motor_;
+        uint32_t refreshTime_;
+        Command command_ = Command::NONE;
+        int32_t value_ = 0;
+        uint32_t lastSent_ = 0;
+        pros::MotorBrake brakeMode_ = pros::MotorBrake::coast;
+        bool brakeModeSet_ = false;
+        DeviceWrites writes_;
+
+        bool isCached(Command command, int32_t value) {
+            if (command != command_ || value != value_ || pros::millis() - lastSent_ >= refreshTime_) return false;
+            writes_.skipped++;
+            return true;
+        }
+
+        void sent(Command command, int32_t value) {
+            command_ = command;
+            value_ = value;
+            lastSent_ = pros::millis();
+            writes_.sent++;
+        }
+};
+
+class CachedDigitalOut {
+    public:
+        explicit CachedDigitalOut(std::shared_ptr<pros::adi::DigitalOut> out,
+                                  uint32_t refreshTime = DEVICE_REFRESH_TIME)
+            : out_(std::move(out)),
+              refreshTime_(refreshTime) {}
+
+        void set(bool value) {
+            if (known_ && value == value_ && pros::millis() - lastSent_ < refreshTime_) {
+                writes_.skipped++;
+                return;
+            }
+            out_->set_value(value);
+            value_ = value;
+            known_ = true;
+            lastSent_ = pros::millis();
+            writes_.sent++;
+        }
+
+        // Forget the last value, so the next one is always sent
+        void invalidate() { known_ = false; }
+
+        const DeviceWrites& getWrites() const { return writes_; }
+    private:
+        std::shared_ptr<pros::adi::DigitalOut> out_;
+        uint32_t refreshTime_;
+        bool value_ = false;
+        bool known_ = false;
+        uint32_t lastSent_ = 0;
+        DeviceWrites writes_;
+};
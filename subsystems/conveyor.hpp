@@ -4,11 +4,14 @@
 #include <cmath>
 #include "pros/optical.hpp"
 #include "holder.hpp"
+#include "stateMachine.hpp"
 #include "subsystem.hpp"
 
 namespace ConveyorNamespace {
 
-enum class State { STOP, INTAKE, OUTTAKE, MIDDLE_GOAL, HIGH_GOAL};
+// MIDDLE_GOAL_FEED is entered from MIDDLE_GOAL after a short wait, and EJECT from HIGH_GOAL to throw a ring of the
+// wrong color off the top of the hood
+enum class State { STOP, INTAKE, OUTTAKE, MIDDLE_GOAL, HIGH_GOAL, MIDDLE_GOAL_FEED, EJECT };
 
 enum Color { RED = 0, BLUE = 1 };
 
@@ -16,9 +19,13 @@ class Conveyor : public subsystem<ConveyorNamespace::State> {
     public:
         Conveyor(SpinnerNamespace::Spinner* intake, SpinnerNamespace::Spinner* hood,
                  std::shared_ptr<pros::Optical> optical_sensor)
-            : intake_(std::move(intake)),
+            : subsystem("conveyor", 1, -1), // runs before the intake and hood, so the states it sets apply this cycle
+              intake_(std::move(intake)),
               hood_(std::move(hood)),
-              optical_sensor_(std::move(optical_sensor)), MiddleGoalTimer(0) {}
+              optical_sensor_(std::move(optical_sensor)) {
+            // a new sample every tick
+            if (optical_sensor_) optical_sensor_->set_integration_time(SubsystemScheduler::PERIOD);
+        }
 
         ~Conveyor() override = default;
 
@@ -26,58 +33,42 @@ class Conveyor : public subsystem<ConveyorNamespace::State> {
 
         // Control conveyor direction based on buttons
         void control(bool button_intake, bool button_outtake, bool button_middle_goal, bool button_high_goal) {
-            if (button_intake) currState = ConveyorNamespace::State::INTAKE;
-            else if (button_outtake) currState = ConveyorNamespace::State::OUTTAKE;
-            else if (button_middle_goal) currState = ConveyorNamespace::State::MIDDLE_GOAL;
-            else if (button_high_goal) currState = ConveyorNamespace::State::HIGH_GOAL;
-            else currState = ConveyorNamespace::State::STOP;
+            ConveyorNamespace::State state = ConveyorNamespace::State::STOP;
+            if (button_intake) state = ConveyorNamespace::State::INTAKE;
+            else if (button_outtake) state = ConveyorNamespace::State::OUTTAKE;
+            else if (button_middle_goal) state = ConveyorNamespace::State::MIDDLE_GOAL;
+            else if (button_high_goal) state = ConveyorNamespace::State::HIGH_GOAL;
 
-            moveToState(currState);
+            moveToState(state);
         }
 
 
-        // Check if a wrong ring is detected based on hue and proximity
-        bool detectWrongRing() {
-        if (!optical_sensor_) return false;  
-        int hue = optical_sensor_->get_hue();
-        if (hue == PROS_ERR_F) return false; 
-
-        int proximity = optical_sensor_->get_proximity();
-        if (proximity < PROXIMITY_THRESHOLD) return false;
-
-        switch (this->init_color_) {
-            case RED:
-                return (hue > BLUE_THRESHOLD && hue < BLUE_HIGH_THRESHOLD);
-            case BLUE:
-                return (hue < RED_THRESHOLD || hue > RED_HIGH_THRESHOLD);
-            default:
-                return false;
+        // Check if a hue is the color of the other alliance's rings
+        bool isWrongColor(double hue) const {
+            switch (init_color_) {
+                case RED:
+                    return (hue > BLUE_THRESHOLD && hue < BLUE_HIGH_THRESHOLD);
+                case BLUE:
+                    return (hue < RED_THRESHOLD || hue > RED_HIGH_THRESHOLD);
+                default:
+                    return false;
             }
         }
 
-        void highGoalWithSensor(int duration_time, int reverse_time) {
-            auto startTime = pros::millis();
+        // Score in the high goal for duration_time ms with the color sort on, then stop. Doesn't block, the conveyor
+        // is back in STOP when it is done
+        void highGoalWithSensor(int duration_time) {
+            std::lock_guard lock(subsystemScheduler().getMutex());
             enable_color_sensor_ = true;
-            bool wrongColorDetected = false;
-
-            moveToState(ConveyorNamespace::State::HIGH_GOAL);
-            while (pros::millis() - startTime < duration_time) {
-                if (enable_color_sensor_ && detectWrongRing()) {
-                    wrongColorDetected = true;
-
-                    intake_->moveToState(SpinnerNamespace::State::BACKWARD);
-                    hood_->moveToState(SpinnerNamespace::State::BACKWARD);
-                    pros::delay(reverse_time);
-                    moveToState(ConveyorNamespace::State::STOP);
-                    break; 
-                }
-                pros::delay(check_interval);
-                }
-           if (!wrongColorDetected) {
-            moveToState(ConveyorNamespace::State::STOP);
-            }
+            moveToState(ConveyorNamespace::State::HIGH_GOAL, duration_time);
         }
-        
+
+        // Whether the conveyor is in a state, or in one of its children (e.g. EJECT is in HIGH_GOAL)
+        bool isIn(ConveyorNamespace::State state) {
+            std::lock_guard lock(subsystemScheduler().getMutex());
+            return machine_.isIn(state);
+        }
+
         // Get the initial wrong hue value
         Color getInitColor() const { return init_color_; }
         bool isColorSensorEnabled() const { return enable_color_sensor_; }
@@ -95,62 +86,159 @@ class Conveyor : public subsystem<ConveyorNamespace::State> {
         // Enable color sensor
         void enable_color_sensor() { enable_color_sensor_ = true; }
 
-        bool is_reversed() { return reverse_ ? true : false; }
+        bool is_reversed() { return isIn(ConveyorNamespace::State::EJECT); }
 
     private:
         SpinnerNamespace::Spinner* intake_;
         SpinnerNamespace::Spinner* hood_;
         std::shared_ptr<pros::Optical> optical_sensor_ = nullptr;
-        std::shared_ptr<pros::Distance> distance_ = nullptr;
-        Color init_color_;
-        bool enable_color_sensor_ = false;
-        bool reverse_ = false;
-        lemlib::Timer MiddleGoalTimer;
-        ConveyorNamespace::State lastState_ = ConveyorNamespace::State::STOP;
-        
-        // Task that runs based on the current state
-        void runTask() override final {
-        // Check for state change to reset timer for MIDDLE_GOAL
-        if (currState != lastState_) {
-            if (currState == ConveyorNamespace::State::MIDDLE_GOAL) {
-                MiddleGoalTimer.reset(); // start timer when entering MIDDLE_GOAL state
+        Color init_color_ = RED;
+        bool enable_color_sensor_ = true; // sort whenever scoring in the high goal, unless turned off
+
+        // Color sort. Every tick the optical sensor is sampled, and each ring that passes it is tracked by how far the
+        // hood has to run forwards for it to reach the top. A ring of the wrong color is thrown off by reversing the
+        // hood when it gets there, so the hood only reverses when it has to and for as long as it takes
+        struct TrackedRing {
+                bool wrong; // whether it is the other alliance's color
+                double top; // hoodTravel_ when it reaches the top, in degrees
+        };
+
+        static constexpr int MAX_RINGS = 4; // the conveyor can't hold more rings than this between the sensor and top
+        std::array<TrackedRing, MAX_RINGS> rings_ {};
+        int ringCount_ = 0;
+        bool ringPresent_ = false; // whether a ring is in front of the sensor, after debouncing
+        bool ringInView_ = false; // whether the last tracked ring is the one in front of the sensor
+        int debounce_ = 0; // samples in a row that disagreed with ringPresent_
+        int ringSamples_ = 0; // samples of the ring in front of the sensor
+        int wrongSamples_ = 0; // how many of them were the wrong color
+        double hoodTravel_ = 0; // how far the hood has run forwards, in degrees. Never goes down
+        double lastHoodPosition_ = NAN;
+        double ejectStart_ = 0; // hood position when the current eject started
+
+        void trackRings() {
+            // the hood runs backwards while intaking, stopped, ejecting and getting out of jams, but the rings in it
+            // don't go back down, so only forward travel moves them towards the top
+            const double position = hood_->get_position();
+            if (position > lastHoodPosition_) hoodTravel_ += position - lastHoodPosition_;
+            lastHoodPosition_ = position;
+            // forget rings that have reached the top of the hood. Wrong ones are kept for a little longer, in case they
+            // reach it between two ticks, and are forgotten once they have left if the color sort didn't throw them off
+            while (ringCount_ > 0 && hoodTravel_ >= rings_[0].top + (rings_[0].wrong ? RING_PASSED_DEGREES : 0))
+                popRing();
+
+            if (!optical_sensor_) return;
+            const double hue = optical_sensor_->get_hue();
+            const int32_t proximity = optical_sensor_->get_proximity();
+            if (hue == PROS_ERR_F || proximity == PROS_ERR) return;
+            const bool near = proximity >= PROXIMITY_THRESHOLD;
+            // every sample of a ring counts, from the ones that confirm it arrived until it is gone
+            if (near) {
+                ringSamples_++;
+                if (isWrongColor(hue)) wrongSamples_++;
             }
-            lastState_ = currState; // update lastState_ to current state
-         }
-
-        switch (currState) {
-            case ConveyorNamespace::State::INTAKE:
-                intake_->moveToState(SpinnerNamespace::State::FORWARD);
-                hood_->moveToState(SpinnerNamespace::State::SLOW_BACKWARD);
-                break;
-            case ConveyorNamespace::State::OUTTAKE:
-                intake_->moveToState(SpinnerNamespace::State::BACKWARD);
-                hood_->moveToState(SpinnerNamespace::State::BACKWARD);
-                break;
-            case ConveyorNamespace::State::MIDDLE_GOAL:
-                if(MiddleGoalTimer.getTimePassed() < 100) break;
-                intake_->moveToState(SpinnerNamespace::State::Medium_Forward);
-                hood_->moveToState(SpinnerNamespace::State::Medium_Forward);
-                break;
-            case ConveyorNamespace::State::HIGH_GOAL:
-                intake_->moveToState(SpinnerNamespace::State::FORWARD);
-                hood_->moveToState(SpinnerNamespace::State::FORWARD);
-                
-
-                break;
-            case ConveyorNamespace::State::STOP:
-                intake_->moveToState(SpinnerNamespace::State::IDLE);
-                hood_->moveToState(SpinnerNamespace::State::SLOW_BACKWARD);
-                break;
-        }
-            
-            if (timer.isDone() and timer.getTimeSet() > 0) {
-                moveToState(ConveyorNamespace::State::STOP);
-                timer.set(0);
+            if (near == ringPresent_) {
+                debounce_ = 0;
+                // a blip too short to be a ring
+                if (!near) ringSamples_ = wrongSamples_ = 0;
+            } else if (++debounce_ >= RING_DEBOUNCE) {
+                ringPresent_ = near;
+                debounce_ = 0;
+                ringInView_ = near && ringCount_ < MAX_RINGS;
+                if (ringInView_) rings_[ringCount_++] = {false, hoodTravel_ + RING_TRAVEL_DEGREES};
+                if (!near) ringSamples_ = wrongSamples_ = 0;
             }
+            // a ring is wrong if most of its samples so far were
+            if (ringInView_) rings_[ringCount_ - 1].wrong = wrongSamples_ * 2 > ringSamples_;
+        }
+
+        void popRing() {
+            for (int i = 1; i < ringCount_; i++) rings_[i - 1] = rings_[i];
+            ringCount_--;
+            if (ringCount_ == 0) ringInView_ = false;
+        }
+
+        // actions
+        void intakeRings() {
+            intake_->moveToState(SpinnerNamespace::State::FORWARD);
+            hood_->moveToState(SpinnerNamespace::State::SLOW_BACKWARD);
+        }
+
+        void reverseRings() {
+            intake_->moveToState(SpinnerNamespace::State::BACKWARD);
+            hood_->moveToState(SpinnerNamespace::State::BACKWARD);
+        }
 
-      
+        void feedMiddleGoal() {
+            intake_->moveToState(SpinnerNamespace::State::Medium_Forward);
+            hood_->moveToState(SpinnerNamespace::State::Medium_Forward);
         }
 
+        void feedHighGoal() {
+            intake_->moveToState(SpinnerNamespace::State::FORWARD);
+            hood_->moveToState(SpinnerNamespace::State::FORWARD);
+        }
+
+        void stopRings() {
+            intake_->moveToState(SpinnerNamespace::State::IDLE);
+            hood_->moveToState(SpinnerNamespace::State::SLOW_BACKWARD);
+        }
+
+        void clearTimeout() { timer.set(0); }
+
+        void startEject() {
+            ejectStart_ = hood_->get_position();
+            popRing();
+        }
+
+        void ejectRing() { hood_->moveToState(SpinnerNamespace::State::BACKWARD); }
+
+        // guards
+        bool timedOut() { return timer.isDone() and timer.getTimeSet() > 0; }
+
+        bool wrongRingAtTop() {
+            return enable_color_sensor_ && ringCount_ > 0 && rings_[0].wrong && hoodTravel_ >= rings_[0].top;
+        }
+
+        bool ejectDone() {
+            return hood_->get_position() <= ejectStart_ - EJECT_DEGREES ||
+                   machine_.timeIn(ConveyorNamespace::State::EJECT) >= EJECT_TIMEOUT;
+        }
+
+        using S = ConveyorNamespace::State;
+        using StateTable = std::array<StateDef<S, Conveyor>, 7>;
+        using TransitionTable = std::array<Transition<S, Conveyor>, 7>;
+
+        // state, parent, entry, exit, during
+        static constexpr StateTable STATES {{
+            {S::STOP, S::STOP, &Conveyor::clearTimeout, nullptr, &Conveyor::stopRings},
+            {S::INTAKE, S::INTAKE, nullptr, nullptr, &Conveyor::intakeRings},
+            {S::OUTTAKE, S::OUTTAKE, nullptr, nullptr, &Conveyor::reverseRings},
+            // the spinners keep doing what they were for a moment before feeding the middle goal
+            {S::MIDDLE_GOAL, S::MIDDLE_GOAL, nullptr, nullptr, nullptr},
+            {S::MIDDLE_GOAL_FEED, S::MIDDLE_GOAL, nullptr, nullptr, &Conveyor::feedMiddleGoal},
+            {S::HIGH_GOAL, S::HIGH_GOAL, nullptr, nullptr, &Conveyor::feedHighGoal},
+            // the intake keeps feeding while the hood reverses
+            {S::EJECT, S::HIGH_GOAL, &Conveyor::startEject, nullptr, &Conveyor::ejectRing},
+        }};
+
+        // from, to, guard, ms in from first
+        static constexpr TransitionTable TRANSITIONS {{
+            {S::MIDDLE_GOAL, S::MIDDLE_GOAL_FEED, nullptr, 100},
+            {S::EJECT, S::HIGH_GOAL, &Conveyor::ejectDone},
+            {S::HIGH_GOAL, S::EJECT, &Conveyor::wrongRingAtTop},
+            // moveToState(state, time) stops the conveyor after time
+            {S::INTAKE, S::STOP, &Conveyor::timedOut},
+            {S::OUTTAKE, S::STOP, &Conveyor::timedOut},
+            {S::MIDDLE_GOAL, S::STOP, &Conveyor::timedOut},
+            {S::HIGH_GOAL, S::STOP, &Conveyor::timedOut},
+        }};
+
+        StateMachine<S, Conveyor, STATES.size(), TRANSITIONS.size()> machine_ {STATES, TRANSITIONS};
+
+        // Task that runs based on the current state
+        void runTask() override final {
+            trackRings();
+            machine_.tick(*this, currState);
+        }
 };
-} // namespace ConveyorNamespace
\ No newline at end of file
+} // namespace ConveyorNamespace
@@ -1,5 +1,6 @@
 #pragma once
 #include "pros/adi.hpp"
+#include "subsystems/cachedDevice.hpp"
 #include "subsystems/subsystem.hpp"
 
 namespace HolderNamespace {
@@ -7,12 +8,15 @@ enum class State { RELEASE, HOLD };
 
 class Holder : public subsystem<HolderNamespace::State> {
     public:
-        Holder(std::shared_ptr<pros::adi::DigitalOut> clamp, std::shared_ptr<pros::Distance> distance)
-            : clamp_(std::move(clamp)),
+        Holder(std::shared_ptr<pros::adi::DigitalOut> clamp, std::shared_ptr<pros::Distance> distance,
+               const char* name = "holder")
+            : subsystem(name, 2), // a solenoid doesn't need updating every 10ms
+              clamp_(std::move(clamp)),
               distance_(std::move(distance)) {}
 
-        Holder(std::shared_ptr<pros::adi::DigitalOut> clamp)
-            : clamp_(std::move(clamp)) {}
+        Holder(std::shared_ptr<pros::adi::DigitalOut> clamp, const char* name = "holder")
+            : subsystem(name, 2),
+              clamp_(std::move(clamp)) {}
 
         // Defaulted destructor as the base class handles task cleanup
         ~Holder() override = default;
@@ -21,7 +25,7 @@ class Holder : public subsystem<HolderNamespace::State> {
         void control(bool button, bool isToggle) {
             if (isToggle) {
                 if (button) {
-                    moveToState(currState == HolderNamespace::State::HOLD ? HolderNamespace::State::RELEASE
+                    moveToState(getState() == HolderNamespace::State::HOLD ? HolderNamespace::State::RELEASE
                                                                         : HolderNamespace::State::HOLD);
                     pros::delay(100);
                 }
@@ -38,12 +42,15 @@ class Holder : public subsystem<HolderNamespace::State> {
 
         void deactivateAuto() { distance_ = nullptr; }
 
+        // How many solenoid commands were sent, and how many were skipped because they hadn't changed
+        const DeviceWrites& getWrites() const { return clamp_.getWrites(); }
+
         bool detectedMogo() {
             return distance_ != nullptr and distance_->get_distance() < 100 and
                    currState != HolderNamespace::State::HOLD;
         }
     private:
-        std::shared_ptr<pros::adi::DigitalOut> clamp_;
+        CachedDigitalOut clamp_; // only written when the state changes
         std::shared_ptr<pros::Distance> distance_ = nullptr;
 
         // Run the task according to the current state
@@ -53,7 +60,7 @@ class Holder : public subsystem<HolderNamespace::State> {
             //     timer.set(AUTO_HOLD_TIMEOUT);
             // };
 
-            clamp_->set_value(currState == HolderNamespace::State::HOLD ? 100 : 0);
+            clamp_.set(currState == HolderNamespace::State::HOLD);
         }
 };
 } // namespace HolderNamespace
\ No newline at end of file
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include "constants.hpp"
+
+// Detects a jammed motor from the mean of its velocity, current and torque over the last JAM_WINDOW samples, so a
+// single noisy sample, or the current spike of a ring being picked up, isn't mistaken for a jam. Fed one sample per
+// tick, and updated in constant time with running sums.
+class JamDetector {
+    public:
+        // Add a sample. Returns true if the window is full and, on average over it, the motor is barely turning while
+        // drawing a stall current and torque
+        bool update(double velocity, double current, double torque) {
+            const std::array<double, 3> sample = {std::fabs(velocity), current, torque};
+            for (int i = 0; i < 3; i++) {
+                if (count_ == JAM_WINDOW) sums_[i] -= window_[next_][i];
+                sums_[i] += sample[i];
+            }
+            window_[next_] = sample;
+            next_ = (next_ + 1) % JAM_WINDOW;
+            if (count_ < JAM_WINDOW) count_++;
+            return count_ == JAM_WINDOW && getMeanVelocity() < STUCK_RPM && getMeanCurrent() > STUCK_CURRENT &&
+                   getMeanTorque() > STUCK_TORQUE;
+        }
+
+        // Forget every sample, e.g. when the motor is commanded to a new speed and has to spin up again
+        void reset() {
+            count_ = 0;
+            next_ = 0;
+            sums_ = {};
+        }
+
+        double getMeanVelocity() const { return count_ > 0 ? sums_[0] / count_ : 0; } // rpm, unsigned
+        double getMeanCurrent() const { return count_ > 0 ? sums_[1] / count_ : 0; } // mA
+        double getMeanTorque() const { return count_ > 0 ? sums_[2] / count_ : 0; } // Nm
+    private:
+        std::array<std::array<double, 3>, JAM_WINDOW> window_ {};
+        std::array<double, 3> sums_ {};
+        int count_ = 0;
+        int next_ = 0;
+};
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include "pros/rtos.hpp"
+#include "lemlib/periodicTask.hpp"
+
+// Runs every subsystem from one fixed rate task, instead of each subsystem running its own task.
+//
+// Each cycle the subsystems are ticked in order of priority (lowest first), and in the order they were added when
+// their priority is the same, so a subsystem that sets the state of others is ticked before them and its commands
+// apply in the same cycle. A subsystem with a divider of n is only ticked every n cycles. The scheduler holds its
+// mutex for the whole cycle, so other tasks that take it never see a subsystem halfway through a tick.
+class SubsystemScheduler {
+    public:
+        static constexpr uint32_t PERIOD = 10; // ms between cycles
+        static constexpr int MAX_SUBSYSTEMS = 16;
+
+        // Add a subsystem. stats records how long each of its ticks takes, and must outlive the subsystem.
+        // Returns a handle to remove it with, or -1 if there is no room left
+        int add(lemlib::TaskStats* stats, int divider, int priority, std::function<void()> tick) {
+            std::lock_guard lock(mutex);
+            if (count >= MAX_SUBSYSTEMS) return -1;
+            // keep the entries sorted by priority, after any others with the same priority
+            int index = count;
+            while (index > 0 && entries[index - 1].priority > priority) {
+                entries[index] = std::move(entries[index - 1]);
+                index--;
+            }
+            entries[index] = {nextHandle, divider > 0 ? divider : 1, priority, stats, std::move(tick)};
+            count++;
+            return nextHandle++;
+        }
+
+        void remove(int handle) {
+            std::lock_guard lock(mutex);
+            for (int i = 0; i < count; i++) {
+                if (entries[i].handle != handle) continue;
+                for (int j = i; j < count - 1; j++) entries[j] = std::move(entries[j + 1]);
+                entries[--count] = {};
+                return;
+            }
+        }
+
+        // Start ticking the subsystems. Subsystems are constructed during static initialization, so this is called
+        // from initialize() rather than when the first one is added, to never tick one that is still being constructed
+        void start() { task.start(); }
+
+        // Held while the subsystems are ticked. Recursive, so a subsystem can change the state of another in its tick
+        pros::RecursiveMutex& getMutex() { return mutex; }
+
+        // Timing statistics of a whole cycle
+        const lemlib::TaskStats& getStats() const { return task.getStats(); }
+    private:
+        struct Entry {
+                int handle = -1;
+                int divider = 1;
+                int priority = 0;
+                lemlib::TaskStats* stats = nullptr;
+                std::function<void()> tick;
+        };
+
+        std::array<Entry, MAX_SUBSYSTEMS> entries {};
+        int count = 0;
+        int nextHandle = 0;
+        uint32_t cycle = 0;
+        pros::RecursiveMutex mutex;
+        lemlib::PeriodicTask task {"subsystems", PERIOD, [this](float) { tickAll(); }};
+
+        void tickAll() {
+            std::lock_guard lock(mutex);
+            for (int i = 0; i < count; i++) {
+                Entry& entry = entries[i];
+                if (cycle % entry.divider != 0) continue;
+                entry.stats->beginCycle();
+                entry.tick();
+                entry.stats->endCycle();
+            }
+            cycle++;
+        }
+};
+
+// The scheduler every subsystem is added to. Created on first use, so it exists before any subsystem
+inline SubsystemScheduler& subsystemScheduler() {
+    static SubsystemScheduler scheduler;
+    return scheduler;
+}
@@ -1,5 +1,8 @@
 #pragma once
+#include "cachedDevice.hpp"
+#include "jamDetector.hpp"
 #include "subsystem.hpp"
+#include "pros/misc.hpp"
 #include "pros/motors.hpp"
 
 namespace SpinnerNamespace {
@@ -8,62 +11,99 @@ enum class State {  IDLE, FORWARD, BACKWARD, SLOW_FORWARD, SLOW_BACKWARD, Medium
 
 class Spinner : public subsystem<State> {
     public:
-        explicit Spinner(std::shared_ptr<pros::Motor> motor)
-            : motor_(std::move(motor)) {
+        explicit Spinner(std::shared_ptr<pros::Motor> motor, const char* name = "spinner")
+            : subsystem(name),
+              motor_(std::move(motor)),
+              output_(motor_) {
             motor_->set_encoder_units(pros::E_MOTOR_ENCODER_DEGREES);
             motor_->tare_position();
         }
 
         virtual ~Spinner() override = default; // Virtual destructor for safe inheritance
 
-        void stuckDetected() {
-            if (fabs(motor_->get_actual_velocity()) < STUCK_RPM && motor_->get_current_draw() > STUCK_CURRENT && motor_->get_torque() > STUCK_TORQUE) {
-                stuck_ = true;
-            }
-        }
+        // Whether the spinner is reversing out of a jam
         bool getStuck() const {
             return stuck_;
         }
 
+        // Number of jams since the program started
+        uint32_t getJams() const { return jams_; }
+
         double get_speed() { // rpm
             return motor_->get_actual_velocity();
         }
         double get_current() { // mA
             return motor_->get_current_draw();
         }
-        void set_speed(double speed) {
-            motor_->move(speed * 1.27);
+        double get_position() { // degrees
+            return motor_->get_position();
         }
-        void reverseSpinnerWhenStuck() {
-            stuckDetected();
-            if (stuck_) {
-                int sign = motor_->get_actual_velocity() > 0 ? 1 : -1;
-                motor_-> move_velocity(-sign * 127);
-                pros::delay(100);
-                motor_->move_velocity(0);
-                stuck_ = false;
-            }
+        void set_speed(double speed) {
+            output_.move(speed * 1.27);
         }
-
         // Get motor object
         std::shared_ptr<pros::Motor> getMotor() { return motor_; }
+
+        // How many motor commands were sent, and how many were skipped because they hadn't changed
+        const DeviceWrites& getWrites() const { return output_.getWrites(); }
     protected:
         std::shared_ptr<pros::Motor> motor_; // Encapsulate member variable
-        bool stuck_ = false; // Flag to indicate if the spinner is stuck
+        CachedMotor output_; // Commands motor_, skipping ones that haven't changed
+        bool stuck_ = false; // Flag to indicate if the spinner is reversing out of a jam
+        JamDetector jamDetector_;
+        uint32_t jams_ = 0;
+        int power_ = 0; // power of the current state
+        uint32_t commandedAt_ = 0; // when the spinner was last commanded a new power, or resumed after a jam
+        uint32_t stuckAt_ = 0; // when the current jam was detected
 
-        // Task to control the arm's movement
+        static int statePower(State state) {
+            switch (state) {
+                case State::FORWARD: return 127;
+                case State::BACKWARD: return -127;
+                case State::IDLE: return 0;
+                case State::SLOW_FORWARD: return 10;
+                case State::SLOW_BACKWARD: return -10;
+                case State::Medium_Forward: return 60;
+                case State::Medium_Backward: return -60;
+            }
+            return 0;
+        }
+
+        // Task to control the spinner's movement
         void runTask() override final {
-            //reverseSpinnerWhenStuck();
-            switch (currState) {
-                case State::FORWARD: motor_->move(127); break;
-                case State::BACKWARD: motor_->move(-127); break;
-                case State::IDLE: motor_->move(0); break;
-                case State::SLOW_FORWARD: motor_->move(10); break;
-                case State::SLOW_BACKWARD: motor_->move(-10); break;
-                case State::Medium_Forward: motor_->move(60); break;
-                case State::Medium_Backward: motor_->move(-60); break;
+            const uint32_t now = pros::millis();
+            const int power = statePower(currState);
+            if (power != power_) {
+                // a new command, which has to spin up before it can jam. It also ends reversing out of a jam
+                power_ = power;
+                commandedAt_ = now;
+                stuck_ = false;
+                jamDetector_.reset();
+            }
+
+            if (stuck_) {
+                if (now - stuckAt_ < JAM_REVERSE_TIME) return;
+                stuck_ = false;
+                commandedAt_ = now;
+                jamDetector_.reset();
+            }
+
+            // only read the motor when it could be jammed, the rest of the time the bus is left to other sensors.
+            // In driver control the driver clears jams, so the spinner does what the buttons say
+            if (withAntiJam && pros::competition::is_autonomous() && std::abs(power) >= JAM_MIN_POWER &&
+                now - commandedAt_ >= JAM_SPINUP_TIME &&
+                jamDetector_.update(motor_->get_actual_velocity(), motor_->get_current_draw(), motor_->get_torque())) {
+                stuck_ = true;
+                stuckAt_ = now;
+                jams_++;
+                // INFO, which initialize() lets through the telemetry sink
+                lemlib::telemetrySink()->info("JAM,{},{},{:.0f},{:.0f},{:.2f}", getStats().getName(), jams_,
+                                              jamDetector_.getMeanVelocity(), jamDetector_.getMeanCurrent(),
+                                              jamDetector_.getMeanTorque());
+                output_.move(power > 0 ? -127 : 127);
+                return;
             }
-            
+            output_.move(power);
         }
 };
 
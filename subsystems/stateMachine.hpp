@@ -0,0 +1,160 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "pros/rtos.hpp"
+
+// A hierarchical state machine for subsystems, described by constexpr tables and run from runTask().
+//
+// A state can have a parent. The parent's during action runs before its child's, and a transition out of the parent
+// is taken from any of its children. Moving between two states runs the exit actions from the old state up to the
+// closest state both are in, then the entry actions from there down to the new state.
+//
+// Every tick, the transitions are checked in the order of the table. One is taken when the machine is in its from
+// state, has been for at least `after` ms, and its guard (if it has one) returns true. Several transitions can be
+// taken in the same tick, so a sequence of steps doesn't wait a tick between each, and nothing has to block.
+//
+// Example:
+//     static constexpr std::array<StateDef<State, Conveyor>, 2> STATES {{
+//         {State::STOP, State::STOP, nullptr, nullptr, &Conveyor::stopSpinners},
+//         {State::EJECT, State::EJECT, nullptr, nullptr, &Conveyor::reverseSpinners},
+//     }};
+//     static constexpr std::array<Transition<State, Conveyor>, 1> TRANSITIONS {{
+//         {State::EJECT, State::STOP, nullptr, 200}, // stop after reversing for 200ms
+//     }};
+//     StateMachine<State, Conveyor, STATES.size(), TRANSITIONS.size()> machine_ {STATES, TRANSITIONS};
+
+template <typename StateType, typename Owner> struct StateDef {
+        StateType state;
+        StateType parent; // the state itself if it doesn't have a parent
+        void (Owner::*entry)() = nullptr; // runs when the state is entered
+        void (Owner::*exit)() = nullptr; // runs when the state is left
+        void (Owner::*during)() = nullptr; // runs every tick while the machine is in the state
+};
+
+template <typename StateType, typename Owner> struct Transition {
+        StateType from;
+        StateType to;
+        bool (Owner::*guard)() = nullptr; // the transition is only taken if this returns true. Always taken if nullptr
+        uint32_t after = 0; // ms the machine has to have been in from first
+};
+
+template <typename StateType, typename Owner, size_t STATES, size_t TRANSITIONS> class StateMachine {
+    public:
+        using StateTable = std::array<StateDef<StateType, Owner>, STATES>;
+        using TransitionTable = std::array<Transition<StateType, Owner>, TRANSITIONS>;
+
+        // Most transitions taken in one tick, so a loop in the table can't hang the scheduler
+        static constexpr int MAX_CHAINED = 8;
+
+        StateMachine(const StateTable& states, const TransitionTable& transitions)
+            : states_(states),
+              transitions_(transitions) {
+            for (size_t i = 0; i < STATES; i++) {
+                parents_[i] = states[i].parent == states[i].state ? -1 : indexOf(states[i].parent);
+            }
+        }
+
+        // Run one tick. state is the subsystem's currState: if something else moved it to a state the machine isn't
+        // in, the machine moves there first. It is set to the state the machine ends the tick in
+        void tick(Owner& owner, StateType& state) {
+            const uint32_t now = pros::millis();
+            const int requested = indexOf(state);
+            if (active_ == -1) {
+                if (requested == -1) return;
+                enter(owner, -1, requested, now);
+                active_ = requested;
+            } else if (requested != -1 && !isIn(requested)) {
+                moveTo(owner, requested, now);
+            }
+
+            for (int chained = 0; chained < MAX_CHAINED; chained++) {
+                const int next = nextTransition(owner, now);
+                if (next == -1) break;
+                moveTo(owner, next, now);
+            }
+
+            runDuring(owner, active_);
+            state = states_[active_].state;
+        }
+
+        // Whether the machine is in a state, or in one of its children
+        bool isIn(StateType state) const { return isIn(indexOf(state)); }
+
+        // ms since the machine entered a state, or 0 if it isn't in it
+        uint32_t timeIn(StateType state) const {
+            const int index = indexOf(state);
+            return isIn(index) ? pros::millis() - entered_[index] : 0;
+        }
+    private:
+        const StateTable& states_;
+        const TransitionTable& transitions_;
+        std::array<int, STATES> parents_ {};
+        std::array<uint32_t, STATES> entered_ {};
+        int active_ = -1;
+
+        int indexOf(StateType state) const {
+            for (size_t i = 0; i < STATES; i++) {
+                if (states_[i].state == state) return i;
+            }
+            return -1;
+        }
+
+        bool isIn(int index) const {
+            if (index == -1) return false;
+            for (int i = active_; i != -1; i = parents_[i]) {
+                if (i == index) return true;
+            }
+            return false;
+        }
+
+        // whether ancestor is a parent of index, or a parent of its parent, and so on
+        bool isAncestor(int ancestor, int index) const {
+            for (int i = parents_[index]; i != -1; i = parents_[i]) {
+                if (i == ancestor) return true;
+            }
+            return false;
+        }
+
+        int nextTransition(Owner& owner, uint32_t now) {
+            for (const Transition<StateType, Owner>& transition : transitions_) {
+                const int from = indexOf(transition.from);
+                const int to = indexOf(transition.to);
+                if (!isIn(from) || now - entered_[from] < transition.after) continue;
+                // a transition from a parent to one of its children is done once the machine is in the child
+                if (isIn(to) && isAncestor(from, to)) continue;
+                if (transition.guard != nullptr && !(owner.*transition.guard)()) continue;
+                return to;
+            }
+            return -1;
+        }
+
+        void moveTo(Owner& owner, int target, uint32_t now) {
+            if (target == -1) return;
+            // leave states until reaching one the target is in. Moving to the current state, or to one of its
+            // parents, leaves and enters it again
+            int common = active_;
+            while (common != -1) {
+                if (isAncestor(common, target)) break;
+                if (states_[common].exit != nullptr) (owner.*states_[common].exit)();
+                common = parents_[common];
+            }
+            enter(owner, common, target, now);
+            active_ = target;
+        }
+
+        // enter every state from the child of from down to target, parents first
+        void enter(Owner& owner, int from, int target, uint32_t now) {
+            if (target == from || target == -1) return;
+            enter(owner, from, parents_[target], now);
+            entered_[target] = now;
+            if (states_[target].entry != nullptr) (owner.*states_[target].entry)();
+        }
+
+        void runDuring(Owner& owner, int index) {
+            if (index == -1) return;
+            runDuring(owner, parents_[index]);
+            if (states_[index].during != nullptr) (owner.*states_[index].during)();
+        }
+};
@@ -1,41 +1,47 @@
 #pragma once
 
+#include <mutex>
 #include "lemlib/api.hpp"
 #include "lemlib/timer.hpp"
+#include "lemlib/taskStats.hpp"
 #include "constants.hpp"
+#include "scheduler.hpp"
 
 template <typename StateType> class subsystem {
     public:
-        subsystem() {
-            task = std::make_unique<pros::Task>([this] { taskRunner(); });
-            task->resume();
-        }
+        // divider: runTask() runs every divider scheduler cycles (10ms each)
+        // priority: subsystems with a lower priority run first each cycle
+        subsystem(const char* name = "subsystem", int divider = 1, int priority = 0)
+            : stats(name, SubsystemScheduler::PERIOD * (divider > 0 ? divider : 1)),
+              handle(subsystemScheduler().add(&stats, divider, priority, [this]() { runTask(); })) {}
 
-        virtual ~subsystem() {
-            if (task) { task->remove(); }
-        }
+        virtual ~subsystem() { subsystemScheduler().remove(handle); }
 
-        void moveToState(StateType newState) { currState = newState; }
+        void moveToState(StateType newState) {
+            std::lock_guard lock(subsystemScheduler().getMutex());
+            currState = newState;
+        }
 
         void moveToState(StateType newState, int time) {
+            std::lock_guard lock(subsystemScheduler().getMutex());
             timer.set(time);
             moveToState(newState);
         }
 
-        StateType getState() { return currState; }
+        StateType getState() {
+            std::lock_guard lock(subsystemScheduler().getMutex());
+            return currState;
+        }
+
+        // Timing statistics of the subsystem's runTask()
+        const lemlib::TaskStats& getStats() const { return stats; }
     protected:
         // Function that will be overridden by derived classes to provide custom task functionality
+        // Called by the subsystem scheduler, which holds its mutex while it runs
         virtual void runTask() = 0;
-        StateType currState;
+        StateType currState {};
         lemlib::Timer timer {0};
     private:
-        std::unique_ptr<pros::Task> task; // Use a unique_ptr to manage the task
-
-        // Internal task function that runs in the base class
-        void taskRunner() {
-            while (true) {
-                runTask(); // Call the derived class's task logic
-                pros::delay(10); // Adjust the delay as necessary
-            }
-        }
+        lemlib::TaskStats stats;
+        int handle; // Handle in the subsystem scheduler, removed when the subsystem is destroyed
 };
@@ -0,0 +1,296 @@
+/*
+ * bench.cpp
+ * Benchmarks for the estimation and control hot paths, run on a computer with Google Benchmark. The particle filter
+ * runs with one thread, as on the brain, and on every core.
+ *
+ * Build and run with `make bench-run`, which stores the results as JSON in bin/host/bench-results/<commit>.json so they can
+ * be compared between commits, for example with Google Benchmark's tools/compare.py.
+ */
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include "particle_filter.h"
+#include "lemlib/driveCurve.hpp"
+#include "lemlib/parallel.hpp"
+#include "lemlib/logger/baseSink.hpp"
+#include "lemlib/chassis/localization.hpp"
+#include "lemlib/chassis/odomIntegrator.hpp"
+#include "lemlib/chassis/pursuitPath.hpp"
+#include "lemlib/chassis/rangeTable.hpp"
+#include "constants.hpp"
+
+/**
+ * @brief Create a particle filter with a given number of particles, spread around the middle of the field
+ *
+ * @param count the number of particles
+ * @return ParticleFilter
+ */
+static ParticleFilter makeParticleFilter(int count) {
+    ParticleFilter pf;
+    pf.gen.seed(1);
+    pf.init(0, 0, 0, lemlib::ParticleFilterSettings().initialNoise.data());
+    std::normal_distribution<double> position(0, 6);
+    std::normal_distribution<double> heading(0, 0.2);
+    pf.num_particles = count;
+    pf.particles.resize(count);
+    pf.weights.assign(count, 1.0 / count);
+    for (int i = 0; i < count; i++) {
+        pf.particles[i] = {i, position(pf.gen), position(pf.gen), heading(pf.gen), 1.0 / count};
+    }
+    return pf;
+}
+
+/**
+ * @brief Distance sensor observations as they are built on the robot
+ *
+ * @return std::vector<LandmarkObs>
+ */
+static std::vector<LandmarkObs> makeObservations() {
+    std::array<lemlib::DistanceMount, lemlib::DISTANCE_SIDES> mounts {};
+    mounts[static_cast<int>(lemlib::DistanceSide::FRONT)] = {0, 5, 0, MAX_DIST_INCHES};
+    mounts[static_cast<int>(lemlib::DistanceSide::LEFT)] = {-5.75, 0, -M_PI / 2, MAX_DIST_INCHES};
+    mounts[static_cast<int>(lemlib::DistanceSide::RIGHT)] = {5.75, 0, M_PI / 2, MAX_DIST_INCHES};
+    lemlib::SensorSnapshot snapshot;
+    snapshot.distances[static_cast<int>(lemlib::DistanceSide::FRONT)] = {true, 600, 63};
+    snapshot.distances[static_cast<int>(lemlib::DistanceSide::LEFT)] = {true, 900, 63};
+    snapshot.distances[static_cast<int>(lemlib::DistanceSide::RIGHT)] = {true, 300, 63};
+    std::default_random_engine gen(1);
+    return lemlib::buildObservations(snapshot, mounts.data(), lemlib::Pose(0, 0.2, 0), lemlib::ParticleFilterSettings(),
+                                     gen);
+}
+
+/**
+ * @brief A path along a sine wave, the way the path generator lays it out
+ *
+ * @param count number of points
+ * @return std::vector<lemlib::Pose> points with the velocity in theta
+ */
+static std::vector<lemlib::Pose> makePath(int count) {
+    std::vector<lemlib::Pose> path;
+    for (int i = 0; i < count; i++) {
+        const float y = i * 0.25;
+        path.push_back(lemlib::Pose(24 * std::sin(y / 24), y, i + 1 < count ? 60 : 0));
+    }
+    return path;
+}
+
+/**
+ * @brief Use the number of threads given by a benchmark's second argument, for as long as it exists
+ */
+class BenchThreads {
+    public:
+        BenchThreads(int threads) {
+            if (threads == 1) return;
+            pool = std::make_unique<lemlib::ThreadPoolBackend>(threads);
+            lemlib::setParallelBackend(pool.get());
+        }
+
+        ~BenchThreads() { lemlib::setParallelBackend(nullptr); }
+    private:
+        std::unique_ptr<lemlib::ThreadPoolBackend> pool;
+};
+
+// particle counts, and thread counts where 0 is every core
+#define PARTICLE_ARGS ArgsProduct({{100, 1000, 10000, 50000}, {1, 0}})->ArgNames({"particles", "threads"})->UseRealTime()
+
+static void BM_ParticlePrediction(benchmark::State& state) {
+    BenchThreads threads(state.range(1));
+    ParticleFilter pf = makeParticleFilter(state.range(0));
+    std::array<double, 3> motionNoise = lemlib::ParticleFilterSettings().motionNoise;
+    for (auto _ : state) {
+        pf.prediction(0.01, motionNoise.data(), 30, 0.5);
+        benchmark::DoNotOptimize(pf.particles.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ParticlePrediction)->PARTICLE_ARGS;
+
+static void BM_ParticleUpdateWeights(benchmark::State& state) {
+    BenchThreads threads(state.range(1));
+    ParticleFilter pf = makeParticleFilter(state.range(0));
+    const std::vector<LandmarkObs> observations = makeObservations();
+    const Map& map = lemlib::getFieldMap();
+    std::array<double, 2> landmarkNoise = lemlib::ParticleFilterSettings().landmarkNoise;
+    for (auto _ : state) {
+        pf.updateWeights(MAX_DIST_INCHES, landmarkNoise.data(), observations, map);
+        benchmark::DoNotOptimize(pf.weights.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ParticleUpdateWeights)->PARTICLE_ARGS;
+
+static void BM_ParticleResample(benchmark::State& state) {
+    BenchThreads threads(state.range(1));
+    ParticleFilter pf = makeParticleFilter(state.range(0));
+    std::array<double, 2> landmarkNoise = lemlib::ParticleFilterSettings().landmarkNoise;
+    pf.updateWeights(MAX_DIST_INCHES, landmarkNoise.data(), makeObservations(), lemlib::getFieldMap());
+    const std::vector<Particle> weighted = pf.particles;
+    for (auto _ : state) {
+        // resample the same weighted set every time, rather than one that has already collapsed
+        state.PauseTiming();
+        pf.particles = weighted;
+        state.ResumeTiming();
+        pf.resample();
+        benchmark::DoNotOptimize(pf.particles.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ParticleResample)->PARTICLE_ARGS;
+
+// the worst case of augmented MCL, where every step replaces as many particles as it is allowed to
+static void BM_ParticleInjection(benchmark::State& state) {
+    ParticleFilter pf = makeParticleFilter(state.range(0));
+    std::array<double, 2> landmarkNoise = lemlib::ParticleFilterSettings().landmarkNoise;
+    pf.updateWeights(MAX_DIST_INCHES, landmarkNoise.data(), makeObservations(), lemlib::getFieldMap());
+    pf.w_slow = 1;
+    pf.w_fast = 0;
+    for (auto _ : state) {
+        pf.injectRandomParticles();
+        benchmark::DoNotOptimize(pf.particles.data());
+    }
+    state.SetItemsProcessed(state.iterations() * pf.injected);
+}
+BENCHMARK(BM_ParticleInjection)->Arg(100)->Arg(1000)->Arg(10000)->Arg(50000)->ArgName("particles");
+
+/**
+ * @brief Random poses on the field, away from the walls
+ *
+ * @param count number of poses
+ * @return std::vector<lemlib::Pose>
+ */
+static std::vector<lemlib::Pose> makePoses(int count) {
+    std::default_random_engine gen(1);
+    std::uniform_real_distribution<float> position(-FEILD_SIZE + 6, FEILD_SIZE - 6);
+    std::uniform_real_distribution<float> heading(0, 2 * M_PI);
+    std::vector<lemlib::Pose> poses;
+    for (int i = 0; i < count; i++) poses.push_back(lemlib::Pose(position(gen), position(gen), heading(gen)));
+    return poses;
+}
+
+// the expected range of one sensor from one pose, looked up the way the beam model weighs each particle
+static void BM_RangeTableLookup(benchmark::State& state) {
+    std::array<lemlib::DistanceMount, lemlib::DISTANCE_SIDES> mounts {};
+    mounts[static_cast<int>(lemlib::DistanceSide::FRONT)] = FRONT_DISTANCE_MOUNT;
+    lemlib::RangeTableGrid grid;
+    grid.fieldHalfSize = FEILD_SIZE;
+    const lemlib::RangeTable table =
+        lemlib::RangeTable::build(mounts.data(), 1u << static_cast<int>(lemlib::DistanceSide::FRONT), grid);
+    const std::vector<lemlib::Pose> poses = makePoses(4096);
+    size_t i = 0;
+    for (auto _ : state) {
+        const lemlib::Pose& pose = poses[i++ % poses.size()];
+        benchmark::DoNotOptimize(table.getExpected(lemlib::DistanceSide::FRONT, pose.x, pose.y, pose.theta));
+    }
+}
+BENCHMARK(BM_RangeTableLookup);
+
+// the same, calculated by casting the beam at the walls
+static void BM_CastRange(benchmark::State& state) {
+    const std::vector<lemlib::Pose> poses = makePoses(4096);
+    size_t i = 0;
+    for (auto _ : state) {
+        const lemlib::Pose& pose = poses[i++ % poses.size()];
+        benchmark::DoNotOptimize(lemlib::castRange(FRONT_DISTANCE_MOUNT, pose.x, pose.y, pose.theta, FEILD_SIZE));
+    }
+}
+BENCHMARK(BM_CastRange);
+
+// lemlib::update reads the sensors through PROS, so this measures the odometry maths it runs each cycle
+static void BM_OdomUpdate(benchmark::State& state) {
+    lemlib::OdomGeometry geometry;
+    geometry.vertical1 = {true, -0.695, false};
+    geometry.vertical2 = {true, 5.75, true};
+    geometry.horizontal1 = {true, -2.625, false};
+    lemlib::OdomIntegrator odometry(geometry);
+    lemlib::SensorSnapshot snapshot;
+    snapshot.imuValid = true;
+    for (auto _ : state) {
+        snapshot.vertical1 += 0.1;
+        snapshot.vertical2 += 0.09;
+        snapshot.horizontal1 += 0.005;
+        snapshot.imuRotation += 0.002;
+        odometry.update(snapshot, 0.005);
+        benchmark::DoNotOptimize(odometry.getPose());
+    }
+}
+BENCHMARK(BM_OdomUpdate);
+
+static void BM_FindClosest(benchmark::State& state) {
+    const std::vector<lemlib::Pose> path = makePath(state.range(0));
+    const lemlib::Pose pose(10, path.size() * 0.125, 0);
+    for (auto _ : state) benchmark::DoNotOptimize(lemlib::findClosest(pose, path));
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_FindClosest)->RangeMultiplier(10)->Range(100, 10000);
+
+static void BM_LookaheadPoint(benchmark::State& state) {
+    const std::vector<lemlib::Pose> path = makePath(state.range(0));
+    // the robot has drifted off the path, so every segment after the closest point is searched
+    const lemlib::Pose pose(60, 0, 0);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(lemlib::lookaheadPoint(lemlib::Pose(0, 0, 0), pose, path, 0, 15));
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_LookaheadPoint)->RangeMultiplier(10)->Range(100, 10000);
+
+static void BM_CircleIntersect(benchmark::State& state) {
+    const lemlib::Pose p1(0, 0), p2(0, 10), pose(1, 2);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(lemlib::circleIntersect(p1, p2, pose, 15));
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_CircleIntersect);
+
+static void BM_GetData(benchmark::State& state) {
+    std::string data;
+    for (const lemlib::Pose& point : makePath(state.range(0)))
+        data += std::to_string(point.x) + ", " + std::to_string(point.y) + ", " + std::to_string(point.theta) + "\n";
+    data += "endData\n";
+    const asset path = {reinterpret_cast<uint8_t*>(data.data()), data.size()};
+    for (auto _ : state) benchmark::DoNotOptimize(lemlib::getData(path));
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_GetData)->RangeMultiplier(10)->Range(100, 10000);
+
+static void BM_ExpoDriveCurve(benchmark::State& state) {
+    lemlib::ExpoDriveCurve curve(3, 10, 1.019);
+    float input = -127;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(curve.curve(input));
+        input = input >= 127 ? -127 : input + 1;
+    }
+}
+BENCHMARK(BM_ExpoDriveCurve);
+
+/**
+ * @brief A sink that formats messages and throws them away, so only the formatting is measured
+ */
+class NullSink : public lemlib::BaseSink {
+    public:
+        NullSink() { setFormat("[LemLib] {level}: {message}"); }
+    protected:
+        void sendMessage(const lemlib::Message& message) override { benchmark::DoNotOptimize(message.message); }
+};
+
+static void BM_SinkLog(benchmark::State& state) {
+    NullSink sink;
+    sink.setLowestLevel(lemlib::Level::INFO);
+    const lemlib::Pose pose(12.5, -30.25, 1.57);
+    for (auto _ : state) sink.info("pose {:.2f} {:.2f} {:.2f} speed {:.2f}", pose.x, pose.y, pose.theta, 42.5f);
+}
+BENCHMARK(BM_SinkLog);
+
+// messages below the lowest level should cost next to nothing
+static void BM_SinkLogFiltered(benchmark::State& state) {
+    NullSink sink;
+    const lemlib::Pose pose(12.5, -30.25, 1.57);
+    for (auto _ : state) sink.debug("pose {:.2f} {:.2f} {:.2f} speed {:.2f}", pose.x, pose.y, pose.theta, 42.5f);
+}
+BENCHMARK(BM_SinkLogFiltered);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,278 @@
+/*
+ * characterize.cpp
+ * Fits a feedforward model to the characterization tests logged by lemlib::Characterization, and suggests PID gains
+ * for it. The log is the terminal output of the robot, saved to a file; lines without "CHAR," are skipped.
+ *
+ * For each mechanism, the power it was given is fitted by least squares to
+ *   power = kS * sign(velocity) + kV * velocity + kA * acceleration [+ kG * cos(position)]
+ * where velocity and acceleration are in the mechanism's units per second, and the kG term is only fitted for
+ * mechanisms gravity acts on, whose position is their angle from horizontal in degrees. The gains are in motor power
+ * (-127 to 127), like the arm's feedforward in constants.hpp.
+ *
+ * The PID gains place both poles of the mechanism, with its feedforward, at the same spot, so it settles without
+ * overshooting in about --settle seconds. kD is in the units of lemlib::PID, which takes the change in error every
+ * 10ms. They are a starting point: a faster settle asks for more power than the motors have for large errors.
+ *
+ * Usage: characterize <log.txt> [--gravity name] [--settle s] [--min-velocity fraction] [--window n]
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief One sample of a test
+ */
+struct Sample {
+        double time; // seconds
+        double power;
+        double position;
+};
+
+/**
+ * @brief The samples of one run of a test
+ */
+struct Run {
+        std::string test;
+        std::vector<Sample> samples;
+};
+
+/**
+ * @brief A row of the least squares problem
+ */
+struct Row {
+        std::vector<double> x;
+        double y;
+};
+
+/**
+ * @brief Split a line of the log into the fields of each characterization record in it
+ *
+ * The telemetry sink doesn't end its messages with a newline, so one line can hold several records, each with the
+ * sink's prefix and suffix around it
+ *
+ * @param line the line
+ * @return std::vector<std::vector<std::string>> the fields of each record, starting with "CHAR"
+ */
+static std::vector<std::vector<std::string>> splitLine(const std::string& line) {
+    std::vector<std::vector<std::string>> records;
+    size_t start = line.find("CHAR,");
+    while (start != std::string::npos) {
+        // a record ends at the sink's suffix, or where the next one starts if it has none
+        const size_t next = line.find("CHAR,", start + 1);
+        const size_t end = std::min(line.find("TELE_END", start), next);
+        std::stringstream stream(line.substr(start, end == std::string::npos ? std::string::npos : end - start));
+        std::vector<std::string> fields;
+        std::string field;
+        while (std::getline(stream, field, ',')) fields.push_back(field);
+        if (fields.size() >= 6) records.push_back(fields);
+        start = next;
+    }
+    return records;
+}
+
+/**
+ * @brief Load the runs of every mechanism from a log
+ *
+ * @param path the log
+ * @param mechanisms set to the runs of each mechanism, by name
+ * @return true if the log could be read
+ */
+static bool loadLog(const std::string& path, std::map<std::string, std::vector<Run>>& mechanisms) {
+    std::ifstream file(path);
+    if (!file) return false;
+    std::string line;
+    while (std::getline(file, line)) {
+        for (const std::vector<std::string>& fields : splitLine(line)) {
+            std::vector<Run>& runs = mechanisms[fields[1]];
+            for (size_t i = 3; i + 2 < fields.size(); i += 3) {
+                const Sample sample {std::atof(fields[i].c_str()) / 1000, std::atof(fields[i + 1].c_str()),
+                                     std::atof(fields[i + 2].c_str())};
+                // a test starts again from time 0, so a run ends when the time goes back
+                if (runs.empty() || runs.back().test != fields[2] || sample.time <= runs.back().samples.back().time)
+                    runs.push_back({fields[2], {}});
+                runs.back().samples.push_back(sample);
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Find the velocity at each sample by central differences, which smooth out sensor noise
+ *
+ * @param samples the samples of a run
+ * @param window how many samples either side to take the difference over
+ * @return std::vector<double> the velocity at each sample, NAN within window of either end
+ */
+static std::vector<double> differentiate(const std::vector<Sample>& samples, int window) {
+    const int count = samples.size();
+    std::vector<double> velocity(count, NAN);
+    for (int i = window; i + window < count; i++) {
+        velocity[i] = (samples[i + window].position - samples[i - window].position) /
+                      (samples[i + window].time - samples[i - window].time);
+    }
+    return velocity;
+}
+
+/**
+ * @brief Solve a linear system with Gaussian elimination
+ *
+ * @param a the matrix, which is changed
+ * @param b the right hand side, which is changed
+ * @return std::vector<double> the solution, or empty if the matrix is singular
+ */
+static std::vector<double> solve(std::vector<std::vector<double>> a, std::vector<double> b) {
+    const size_t n = b.size();
+    for (size_t col = 0; col < n; col++) {
+        size_t pivot = col;
+        for (size_t row = col + 1; row < n; row++)
+            if (std::fabs(a[row][col]) > std::fabs(a[pivot][col])) pivot = row;
+        if (std::fabs(a[pivot][col]) < 1e-12) return {};
+        std::swap(a[col], a[pivot]);
+        std::swap(b[col], b[pivot]);
+        for (size_t row = col + 1; row < n; row++) {
+            const double factor = a[row][col] / a[col][col];
+            for (size_t k = col; k < n; k++) a[row][k] -= factor * a[col][k];
+            b[row] -= factor * b[col];
+        }
+    }
+    std::vector<double> x(n);
+    for (size_t row = n; row-- > 0;) {
+        double sum = b[row];
+        for (size_t k = row + 1; k < n; k++) sum -= a[row][k] * x[k];
+        x[row] = sum / a[row][row];
+    }
+    return x;
+}
+
+/**
+ * @brief Fit the rows by least squares
+ *
+ * @param rows the rows
+ * @return std::vector<double> the coefficients, or empty if they can't be fitted
+ */
+static std::vector<double> leastSquares(const std::vector<Row>& rows) {
+    if (rows.empty()) return {};
+    const size_t n = rows[0].x.size();
+    std::vector<std::vector<double>> a(n, std::vector<double>(n, 0));
+    std::vector<double> b(n, 0);
+    for (const Row& row : rows) {
+        for (size_t i = 0; i < n; i++) {
+            for (size_t j = 0; j < n; j++) a[i][j] += row.x[i] * row.x[j];
+            b[i] += row.x[i] * row.y;
+        }
+    }
+    return solve(a, b);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s <log.txt> [--gravity name] [--settle s] [--min-velocity fraction]"
+                     " [--window n]\n", argv[0]);
+        return 1;
+    }
+    std::vector<std::string> gravity;
+    double settle = 1;
+    double minVelocity = 0.05;
+    int window = 2;
+    for (int i = 2; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::fprintf(stderr, "%s needs a value\n", arg.c_str());
+            return 1;
+        }
+        const std::string value = argv[++i];
+        if (arg == "--gravity") gravity.push_back(value);
+        else if (arg == "--settle") settle = std::strtod(value.c_str(), nullptr);
+        else if (arg == "--min-velocity") minVelocity = std::strtod(value.c_str(), nullptr);
+        else if (arg == "--window") window = std::max(1, std::atoi(value.c_str()));
+        else {
+            std::fprintf(stderr, "unknown option %s\n", arg.c_str());
+            return 1;
+        }
+    }
+    // the arm logged by main.cpp's characterize() is the only mechanism gravity acts on, unless told otherwise
+    if (gravity.empty()) gravity.push_back("arm");
+
+    std::map<std::string, std::vector<Run>> mechanisms;
+    if (!loadLog(argv[1], mechanisms)) {
+        std::fprintf(stderr, "can't read %s\n", argv[1]);
+        return 1;
+    }
+    if (mechanisms.empty()) {
+        std::fprintf(stderr, "no CHAR lines in %s\n", argv[1]);
+        return 1;
+    }
+
+    for (const auto& [name, runs] : mechanisms) {
+        const bool hasGravity = std::find(gravity.begin(), gravity.end(), name) != gravity.end();
+        std::vector<std::vector<double>> velocities;
+        double fastest = 0;
+        for (const Run& run : runs) {
+            velocities.push_back(differentiate(run.samples, window));
+            for (double v : velocities.back())
+                if (!std::isnan(v)) fastest = std::max(fastest, std::fabs(v));
+        }
+        // samples where the mechanism is barely moving are dominated by static friction, which the model doesn't have
+        std::vector<Row> moving;
+        for (size_t r = 0; r < runs.size(); r++) {
+            const std::vector<Sample>& samples = runs[r].samples;
+            const std::vector<double>& velocity = velocities[r];
+            for (int i = 2 * window; i + 2 * window < int(samples.size()); i++) {
+                const double v = velocity[i];
+                if (std::fabs(v) < minVelocity * fastest) continue;
+                const double acceleration = (velocity[i + window] - velocity[i - window]) /
+                                            (samples[i + window].time - samples[i - window].time);
+                Row row {{v > 0 ? 1.0 : -1.0, v, acceleration}, samples[i].power};
+                if (hasGravity) row.x.push_back(std::cos(samples[i].position * M_PI / 180));
+                moving.push_back(row);
+            }
+        }
+        const std::vector<double> gains = leastSquares(moving);
+        if (gains.empty()) {
+            std::printf("%s: not enough samples where it moved to fit\n", name.c_str());
+            continue;
+        }
+
+        // how well the model fits
+        double mean = 0;
+        for (const Row& row : moving) mean += row.y / moving.size();
+        double residual = 0, total = 0;
+        for (const Row& row : moving) {
+            double predicted = 0;
+            for (size_t i = 0; i < gains.size(); i++) predicted += gains[i] * row.x[i];
+            residual += (row.y - predicted) * (row.y - predicted);
+            total += (row.y - mean) * (row.y - mean);
+        }
+        const double kS = gains[0], kV = gains[1], kA = gains[2];
+        std::printf("%s: %zu runs, %zu samples, r^2 %.3f, rms error %.2f power\n", name.c_str(), runs.size(),
+                    moving.size(), total > 0 ? 1 - residual / total : 0, std::sqrt(residual / moving.size()));
+        std::printf("  kS %.3f  kV %.4f  kA %.5f", kS, kV, kA);
+        if (hasGravity) std::printf("  kG %.3f", gains[3]);
+        std::printf("\n");
+        // the limits of a profile the mechanism can follow, ignoring gravity
+        if (kV > 0 && kA > 0)
+            std::printf("  at full power: max velocity %.1f, max acceleration from rest %.1f\n", (127 - kS) / kV,
+                        (127 - kS) / kA);
+
+        // with the feedforward, power = kP * e + kD' * de/dt moves the mechanism as kA x'' + kV x' = power, so the
+        // poles are the roots of kA s^2 + (kV + kD') s + kP. Both at -w settles in about 5.8 / w
+        if (kA <= 0) {
+            std::printf("  kA isn't positive, so there are no PID gains to suggest. Check the dynamic tests\n");
+            continue;
+        }
+        const double w = 5.8 / settle;
+        const double kP = kA * w * w;
+        const double kD = std::max(0.0, 2 * kA * w - kV);
+        // lemlib::PID's derivative is the change in error over 10ms
+        std::printf("  PID for a %.2fs settle: kP %.3f  kI 0  kD %.3f\n", settle, kP, kD / 0.01);
+    }
+    return 0;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+// Host stand-in for the parts of pros/rtos.hpp used by the code the host tools build, so LemLib's logger and
+// algorithms can run on a computer. Nothing here is used on the robot.
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace pros {
+/**
+ * @brief Get the time since the program started
+ *
+ * @return std::uint64_t time in microseconds
+ */
+inline std::uint64_t micros() {
+    static const auto start = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Get the time since the program started
+ *
+ * @return std::uint32_t time in milliseconds
+ */
+inline std::uint32_t millis() { return micros() / 1000; }
+
+/**
+ * @brief Sleep the current thread
+ *
+ * @param milliseconds how long to sleep
+ */
+inline void delay(std::uint32_t milliseconds) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+}
+
+class Mutex {
+    public:
+        bool take(std::uint32_t /*timeout*/ = 0) {
+            mutex.lock();
+            return true;
+        }
+
+        bool give() {
+            mutex.unlock();
+            return true;
+        }
+
+        void lock() { mutex.lock(); }
+
+        void unlock() { mutex.unlock(); }
+    private:
+        std::mutex mutex;
+};
+
+class Task {
+    public:
+        template <typename F> Task(F&& function, const char* /*name*/ = "") {
+            std::thread(std::forward<F>(function)).detach();
+        }
+};
+} // namespace pros
@@ -0,0 +1,146 @@
+/*
+ * rangeTable.cpp
+ * Generates the table of the distance each distance sensor should read at every pose on the field, for the sensor
+ * mounts in constants.hpp, and writes it to static/rangeTable.bin to be embedded with ASSET(rangeTable_bin).
+ *
+ * The table is read back and checked against the exact distances at random poses, and the time a query takes is
+ * compared to calculating the distance. A finer grid is more accurate but takes more flash and memory.
+ *
+ * Usage: rangeTable [--out file] [--positions n] [--headings n] [--resolution in] [--tolerance in] [--checks n]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include "lemlib/chassis/rangeTable.hpp"
+#include "constants.hpp"
+
+/**
+ * @brief Time a function over a set of poses
+ *
+ * @param poses x, y and theta of each pose
+ * @param query the function, given a pose
+ * @param sink where the results are summed, so they aren't optimized away
+ * @return double nanoseconds per call
+ */
+template <typename F> static double timeQueries(const std::vector<std::array<float, 3>>& poses, F query, float& sink) {
+    const auto start = std::chrono::steady_clock::now();
+    for (const auto& pose : poses) sink += query(pose[0], pose[1], pose[2]);
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / poses.size();
+}
+
+int main(int argc, char** argv) {
+    std::string outFile = "static/rangeTable.bin";
+    lemlib::RangeTableGrid grid;
+    grid.fieldHalfSize = FEILD_SIZE;
+    int checks = 1000000;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::fprintf(stderr, "%s needs a value\n", arg.c_str());
+            return 1;
+        }
+        const std::string value = argv[++i];
+        if (arg == "--out") outFile = value;
+        else if (arg == "--positions") grid.positions = std::atoi(value.c_str());
+        else if (arg == "--headings") grid.headings = std::atoi(value.c_str());
+        else if (arg == "--resolution") grid.resolution = std::strtod(value.c_str(), nullptr);
+        else if (arg == "--tolerance") grid.tolerance = std::strtod(value.c_str(), nullptr);
+        else if (arg == "--checks") checks = std::max(1, std::atoi(value.c_str()));
+        else {
+            std::fprintf(stderr, "unknown option %s\n", arg.c_str());
+            return 1;
+        }
+    }
+    if (grid.positions < 2 || grid.positions > UINT16_MAX || grid.headings < 1 || grid.headings > UINT16_MAX ||
+        grid.resolution <= 0) {
+        std::fprintf(stderr, "the grid needs at least 2 positions, 1 heading and a positive resolution\n");
+        return 1;
+    }
+
+    // the mounts the robot has, indexed by DistanceSide
+    std::array<lemlib::DistanceMount, lemlib::DISTANCE_SIDES> mounts {};
+    mounts[static_cast<int>(lemlib::DistanceSide::LEFT)] = LEFT_DISTANCE_MOUNT;
+    mounts[static_cast<int>(lemlib::DistanceSide::RIGHT)] = RIGHT_DISTANCE_MOUNT;
+    mounts[static_cast<int>(lemlib::DistanceSide::FRONT)] = FRONT_DISTANCE_MOUNT;
+    const uint32_t sides = 1u << static_cast<int>(lemlib::DistanceSide::LEFT) |
+                           1u << static_cast<int>(lemlib::DistanceSide::RIGHT) |
+                           1u << static_cast<int>(lemlib::DistanceSide::FRONT);
+
+    // generate and compress the table
+    const lemlib::RangeTable built = lemlib::RangeTable::build(mounts.data(), sides, grid);
+    std::vector<uint8_t> encoded = built.encode();
+    FILE* out = std::fopen(outFile.c_str(), "wb");
+    if (!out) {
+        std::fprintf(stderr, "could not open %s\n", outFile.c_str());
+        return 1;
+    }
+    std::fwrite(encoded.data(), 1, encoded.size(), out);
+    std::fclose(out);
+
+    // read it back the way the robot does
+    lemlib::RangeTable table;
+    if (!table.load({encoded.data(), encoded.size()})) {
+        std::fprintf(stderr, "the table written can't be read back\n");
+        return 1;
+    }
+    std::printf("wrote %s: %d x %d positions, %d headings, %zu bytes (%zu in memory, %.1fx smaller)\n",
+                outFile.c_str(), grid.positions, grid.positions, grid.headings, encoded.size(),
+                table.getMemoryUsage(), static_cast<double>(table.getMemoryUsage()) / encoded.size());
+
+    // compare the table to the exact distances at random poses, away from the walls like the robot
+    std::mt19937 gen(0);
+    const float limit = grid.fieldHalfSize - 6;
+    std::uniform_real_distribution<float> position(-limit, limit);
+    std::uniform_real_distribution<float> heading(0, 2 * M_PI);
+    std::vector<std::array<float, 3>> poses(checks);
+    for (auto& pose : poses) pose = {position(gen), position(gen), heading(gen)};
+    std::printf("%6s %10s %10s %10s %12s\n", "sensor", "rms (in)", "max (in)", "range (%)", "p99 (in)");
+    for (int side = 0; side < lemlib::DISTANCE_SIDES; side++) {
+        if (!(sides & (1u << side))) continue;
+        double sumSquared = 0, maxError = 0;
+        int compared = 0, disagreed = 0;
+        std::vector<float> errors;
+        for (const auto& pose : poses) {
+            const float exact = lemlib::castRange(mounts[side], pose[0], pose[1], pose[2], grid.fieldHalfSize);
+            const float looked =
+                table.getExpected(static_cast<lemlib::DistanceSide>(side), pose[0], pose[1], pose[2]);
+            // the table can only be wrong about whether the wall is in range right at the edge of the range
+            if (std::isinf(exact) != std::isinf(looked)) {
+                disagreed++;
+                continue;
+            }
+            if (std::isinf(exact)) continue;
+            const double error = std::fabs(looked - exact);
+            sumSquared += error * error;
+            maxError = std::max(maxError, error);
+            errors.push_back(error);
+            compared++;
+        }
+        std::sort(errors.begin(), errors.end());
+        std::printf("%6s %10.3f %10.3f %10.2f %12.3f\n", lemlib::DISTANCE_SIDE_NAMES[side],
+                    std::sqrt(sumSquared / std::max(compared, 1)), maxError, 100.0 * disagreed / poses.size(),
+                    errors.empty() ? 0 : errors[errors.size() * 99 / 100]);
+    }
+
+    // what a query costs compared to casting the beam
+    float sink = 0;
+    const lemlib::DistanceMount& mount = mounts[static_cast<int>(lemlib::DistanceSide::FRONT)];
+    const double castTime = timeQueries(
+        poses, [&](float x, float y, float theta) { return lemlib::castRange(mount, x, y, theta, grid.fieldHalfSize); },
+        sink);
+    const double tableTime = timeQueries(
+        poses,
+        [&](float x, float y, float theta) {
+            return std::fmin(table.getExpected(lemlib::DistanceSide::FRONT, x, y, theta), 1000);
+        },
+        sink);
+    std::printf("query %.1f ns, cast %.1f ns (%g)\n", tableTime, castTime, sink > 0 ? 0.0 : 1.0);
+    return 0;
+}
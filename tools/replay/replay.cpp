@@ -0,0 +1,207 @@
+/*
+ * replay.cpp
+ * Runs odometry and the particle filter offline from a recorded sensor log, as fast as the computer allows. See
+ * replayEngine.hpp for the log format.
+ *
+ * With --trace, the odometry and filter poses after every update are written to a CSV file, with theta in radians:
+ *   time_us, odom_x, odom_y, odom_theta, filter_x, filter_y, filter_theta, injected
+ *
+ * With --range-table, the particle filter is weighed with a beam model using the range table from make range-table,
+ * instead of with landmark observations.
+ *
+ * Usage: replay <log.csv> [--gt file] [--map file] [--midpoint] [--no-pf] [--seed n] [--threads n] [--particles n]
+ *               [--max-injection fraction] [--trace file] [--localize x,y,theta_deg] [--range-table file]
+ *               [--vertical1 offset|none] [--vertical2 offset|none] [--horizontal1 offset|none]
+ *               [--horizontal2 offset|none] [--driven wheel]
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include "lemlib/parallel.hpp"
+#include "replayEngine.hpp"
+
+/**
+ * @brief Parse a tracking wheel option
+ *
+ * @param value the offset in inches, or "none" if there's no wheel
+ * @param wheel the wheel to change
+ */
+static void parseWheel(const char* value, lemlib::OdomWheel& wheel) {
+    if (std::strcmp(value, "none") == 0) wheel = {};
+    else wheel = {true, std::strtof(value, nullptr), wheel.driven};
+}
+
+/**
+ * @brief Read a whole file
+ *
+ * @param path the file
+ * @param contents set to the contents of the file
+ * @return true if the file was read
+ */
+static bool readFile(const std::string& path, std::vector<uint8_t>& contents) {
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) return false;
+    uint8_t buffer[4096];
+    size_t count;
+    while ((count = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+        contents.insert(contents.end(), buffer, buffer + count);
+    std::fclose(file);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr,
+                     "usage: %s <log.csv> [--gt file] [--map file] [--midpoint] [--no-pf] [--seed n] [--threads n]"
+                     " [--particles n]\n"
+                     "       [--max-injection fraction] [--trace file] [--localize x,y,theta_deg]"
+                     " [--range-table file]\n"
+                     "       [--vertical1|--vertical2|--horizontal1|--horizontal2 offset|none] [--driven wheel]\n",
+                     argv[0]);
+        return 1;
+    }
+
+    ReplayConfig config;
+    std::string gtFile, mapFile, traceFile, rangeTableFile;
+    int threads = 1;
+    for (int i = 2; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg != "--midpoint" && arg != "--no-pf" && i + 1 >= argc) {
+            std::fprintf(stderr, "%s needs a value\n", arg.c_str());
+            return 1;
+        }
+        if (arg == "--gt") gtFile = argv[++i];
+        else if (arg == "--map") mapFile = argv[++i];
+        else if (arg == "--midpoint") config.integration = lemlib::OdomIntegration::MIDPOINT;
+        else if (arg == "--no-pf") config.runParticleFilter = false;
+        else if (arg == "--seed") config.seed = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--threads") threads = std::atoi(argv[++i]);
+        else if (arg == "--trace") traceFile = argv[++i];
+        else if (arg == "--range-table") rangeTableFile = argv[++i];
+        else if (arg == "--localize") {
+            float x, y, theta;
+            if (std::sscanf(argv[++i], "%f,%f,%f", &x, &y, &theta) != 3) {
+                std::fprintf(stderr, "--localize needs x,y,theta\n");
+                return 1;
+            }
+            config.localize = true;
+            config.localizeHint = lemlib::Pose(x, y, theta * M_PI / 180);
+        }
+        else if (arg == "--max-injection") config.settings.maxInjection = std::strtod(argv[++i], nullptr);
+        else if (arg == "--particles") config.settings.particles = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--vertical1") parseWheel(argv[++i], config.geometry.vertical1);
+        else if (arg == "--vertical2") parseWheel(argv[++i], config.geometry.vertical2);
+        else if (arg == "--horizontal1") parseWheel(argv[++i], config.geometry.horizontal1);
+        else if (arg == "--horizontal2") parseWheel(argv[++i], config.geometry.horizontal2);
+        else if (arg == "--driven") {
+            const std::string wheel = argv[++i];
+            if (wheel == "vertical1") config.geometry.vertical1.driven = true;
+            else if (wheel == "vertical2") config.geometry.vertical2.driven = true;
+            else if (wheel == "horizontal1") config.geometry.horizontal1.driven = true;
+            else if (wheel == "horizontal2") config.geometry.horizontal2.driven = true;
+        } else {
+            std::fprintf(stderr, "unknown option %s\n", arg.c_str());
+            return 1;
+        }
+    }
+
+    // load the log
+    ReplayLog log;
+    const std::string error = loadReplayLog(argv[1], gtFile, log);
+    if (!error.empty()) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    if (!mapFile.empty() && !read_map_data(mapFile, config.map)) {
+        std::fprintf(stderr, "could not open %s\n", mapFile.c_str());
+        return 1;
+    }
+    lemlib::RangeTable rangeTable;
+    if (!rangeTableFile.empty()) {
+        std::vector<uint8_t> file;
+        if (!readFile(rangeTableFile, file) || !rangeTable.load({file.data(), file.size()})) {
+            std::fprintf(stderr, "could not read the range table %s\n", rangeTableFile.c_str());
+            return 1;
+        }
+        // the table has to cover every sensor in the log, mounted the same way
+        uint32_t sides = 0;
+        for (const lemlib::SensorSnapshot& snapshot : log.snapshots) {
+            for (int side = 0; side < lemlib::DISTANCE_SIDES; side++)
+                sides |= static_cast<uint32_t>(snapshot.distances[side].valid) << side;
+        }
+        if (!rangeTable.matches(config.mounts.data(), sides)) {
+            std::fprintf(stderr, "%s wasn't generated for these distance sensors\n", rangeTableFile.c_str());
+            return 1;
+        }
+        config.rangeTable = &rangeTable;
+    }
+
+    // spread the particle filter over several cores. 0 uses every core
+    std::unique_ptr<lemlib::ThreadPoolBackend> pool;
+    if (threads != 1) {
+        pool = std::make_unique<lemlib::ThreadPoolBackend>(threads);
+        lemlib::setParallelBackend(pool.get());
+    }
+    config.recordTrace = !traceFile.empty();
+    ReplayResult result = runReplay(log, config);
+    lemlib::setParallelBackend(nullptr);
+
+    // report
+    const double logTime = log.duration();
+    const lemlib::Pose& pose = result.finalPose;
+    std::printf("replayed %zu readings covering %.2f s in %.3f s (%.0fx real time)\n", log.snapshots.size(), logTime,
+                result.replayTime, result.replayTime > 0 ? logTime / result.replayTime : 0);
+    std::printf("final pose   x %.3f in, y %.3f in, theta %.3f deg, distance traveled %.2f in, imu bias %.5f rad\n",
+                pose.x, pose.y, pose.theta * 180 / M_PI, result.distanceTraveled, result.imuBias);
+    std::vector<double>& stepTimes = result.stepTimes;
+    std::sort(stepTimes.begin(), stepTimes.end());
+    double sumStep = 0;
+    for (double time : stepTimes) sumStep += time;
+    std::printf("step cost    mean %.2f us, p99 %.2f us, max %.2f us\n", sumStep / stepTimes.size(),
+                stepTimes[stepTimes.size() * 99 / 100], stepTimes.back());
+    if (result.filterSteps > 0)
+        std::printf("filter cost  %.2f us cpu per step over %d steps\n",
+                    result.filterCpuTime / result.filterSteps * 1e6, result.filterSteps);
+    if (config.localize) {
+        const lemlib::GlobalLocalization& found = result.localization;
+        if (!found.found) std::printf("localize     not enough readings (%d usable)\n", found.used);
+        else {
+            std::printf("localize     x %.3f in, y %.3f in, theta %.3f deg, error %.2f sd, %d readings,"
+                        " %d poses in %u us\n",
+                        found.pose.x, found.pose.y, found.pose.theta * 180 / M_PI, found.error, found.used,
+                        found.evaluated, found.time);
+            if (std::isfinite(found.gap))
+                std::printf("             next best x %.3f in, y %.3f in, theta %.3f deg, worse by %.2f\n",
+                            found.alternative.x, found.alternative.y, found.alternative.theta * 180 / M_PI, found.gap);
+        }
+    }
+    if (result.injectionSteps > 0)
+        std::printf("recovery     injected %ld particles in %d steps, %llu us in total, at most %llu us per step\n",
+                    result.injectedParticles, result.injectionSteps,
+                    static_cast<unsigned long long>(result.injectionTime),
+                    static_cast<unsigned long long>(result.maxInjectionTime));
+    result.odomError.print("odometry");
+    result.filterError.print("filter");
+
+    if (!traceFile.empty()) {
+        FILE* trace = std::fopen(traceFile.c_str(), "w");
+        if (!trace) {
+            std::fprintf(stderr, "could not open %s\n", traceFile.c_str());
+            return 1;
+        }
+        std::fprintf(trace, "time_us,odom_x,odom_y,odom_theta,filter_x,filter_y,filter_theta,injected\n");
+        for (const ReplayTraceEntry& entry : result.trace) {
+            std::fprintf(trace, "%llu,%.4f,%.4f,%.5f,%.4f,%.4f,%.5f,%d\n",
+                         static_cast<unsigned long long>(entry.timestamp), entry.odometry.x, entry.odometry.y,
+                         entry.odometry.theta, entry.filter.x, entry.filter.y, entry.filter.theta, entry.injected);
+        }
+        std::fclose(trace);
+    }
+    return 0;
+}
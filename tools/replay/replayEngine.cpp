@@ -0,0 +1,180 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+#include "replayEngine.hpp"
+
+// run the particle filter at 100Hz, the same as lemlib::update
+constexpr float PARTICLE_FILTER_PERIOD = 0.0095;
+// snapshots used to find the starting pose, the same as lemlib::localize
+constexpr size_t LOCALIZE_SAMPLES = 5;
+
+void ErrorStats::add(const ground_truth& gt, double x, double y, double theta) {
+    // not getError(), which returns a static array that the sweep's threads would share
+    const double position = std::hypot(x - gt.x, y - gt.y);
+    double heading = std::fmod(std::fabs(theta - gt.theta), 2 * M_PI);
+    if (heading > M_PI) heading = 2 * M_PI - heading;
+    sumPosition += position;
+    sumSquaredPosition += position * position;
+    maxPosition = std::max(maxPosition, position);
+    sumHeading += heading;
+    maxHeading = std::max(maxHeading, heading);
+    count++;
+}
+
+double ErrorStats::rmsPosition() const { return count == 0 ? INFINITY : std::sqrt(sumSquaredPosition / count); }
+
+void ErrorStats::print(const char* name) const {
+    if (count == 0) return;
+    std::printf("%-13s position mean %.3f in, rms %.3f in, max %.3f in | heading mean %.3f deg, max %.3f deg\n", name,
+                sumPosition / count, rmsPosition(), maxPosition, sumHeading / count * 180 / M_PI,
+                maxHeading * 180 / M_PI);
+}
+
+double ReplayLog::duration() const {
+    if (snapshots.empty()) return 0;
+    return (snapshots.back().timestamp - snapshots.front().timestamp) / 1000000.0;
+}
+
+/**
+ * @brief Parse one line of the sensor log
+ *
+ * @param line the line
+ * @param snapshot the snapshot to fill in
+ * @return true if the line held a reading
+ */
+static bool parseLine(const std::string& line, lemlib::SensorSnapshot& snapshot) {
+    // split the line into fields, keeping empty ones
+    std::vector<std::string> fields;
+    std::istringstream in(line);
+    for (std::string field; std::getline(in, field, ',');) fields.push_back(field);
+    if (fields.size() < 6) return false;
+    // parse a field, returning nan if it is empty or not a number
+    auto number = [&](size_t i) -> double {
+        if (i >= fields.size()) return NAN;
+        char* end;
+        const double value = std::strtod(fields[i].c_str(), &end);
+        return end == fields[i].c_str() ? NAN : value;
+    };
+    if (std::isnan(number(0))) return false;
+
+    snapshot.timestamp = static_cast<uint64_t>(number(0));
+    snapshot.vertical1 = number(1);
+    snapshot.vertical2 = number(2);
+    snapshot.horizontal1 = number(3);
+    snapshot.horizontal2 = number(4);
+    const double imu = number(5);
+    snapshot.imuValid = !std::isnan(imu);
+    snapshot.imuRotation = snapshot.imuValid ? imu * M_PI / 180 : 0;
+    for (int side = 0; side < lemlib::DISTANCE_SIDES; side++) {
+        const double distance = number(6 + side * 2);
+        const double confidence = number(7 + side * 2);
+        lemlib::DistanceReading& reading = snapshot.distances[side];
+        reading.valid = distance >= 0;
+        reading.distance = reading.valid ? static_cast<int32_t>(distance) : 0;
+        reading.confidence = std::isnan(confidence) ? 0 : static_cast<int32_t>(confidence);
+    }
+    return true;
+}
+
+std::string loadReplayLog(const std::string& logFile, const std::string& gtFile, ReplayLog& log) {
+    std::ifstream in(logFile);
+    if (!in) return "could not open " + logFile;
+    log.snapshots.clear();
+    for (std::string line; std::getline(in, line);) {
+        lemlib::SensorSnapshot snapshot;
+        if (parseLine(line, snapshot)) log.snapshots.push_back(snapshot);
+    }
+    if (log.snapshots.size() < 2) return logFile + " has fewer than 2 readings";
+    log.gt.clear();
+    if (!gtFile.empty() && !read_gt_data(gtFile, log.gt)) return "could not open " + gtFile;
+    return "";
+}
+
+/**
+ * @brief Get the CPU time used by the calling thread
+ *
+ * @return double time in seconds
+ */
+static double threadCpuTime() {
+    timespec time;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+ReplayResult runReplay(const ReplayLog& log, const ReplayConfig& config) {
+    ReplayResult result;
+    const std::vector<lemlib::SensorSnapshot>& snapshots = log.snapshots;
+    const std::vector<ground_truth>& gt = log.gt;
+
+    // start where the ground truth starts, if there is one, or find the robot the same way lemlib::localize does
+    const ground_truth start = gt.empty() ? ground_truth {0, 0, 0} : gt[0];
+    lemlib::Pose startPose(start.x, start.y, start.theta);
+    if (config.localize) {
+        const std::array<lemlib::DistanceReading, lemlib::DISTANCE_SIDES> readings =
+            lemlib::medianDistances(snapshots.data(), std::min<size_t>(snapshots.size(), LOCALIZE_SAMPLES));
+        result.localization = lemlib::localizeGlobally(readings.data(), config.mounts.data(), lemlib::DISTANCE_SIDES,
+                                                       config.localizeHint, config.localizeSettings);
+        if (result.localization.found) startPose = result.localization.pose;
+    }
+    lemlib::OdomIntegrator odometry(config.geometry, config.integration);
+    odometry.setPose(startPose);
+    std::default_random_engine gen(config.seed);
+    ParticleFilter pf;
+    pf.gen.seed(config.seed);
+    if (config.runParticleFilter) lemlib::seedParticleFilter(pf, config.settings, startPose, gen);
+
+    result.stepTimes.reserve(snapshots.size());
+    float particleFilterElapsed = 0;
+    const auto replayStart = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < snapshots.size(); i++) {
+        const auto stepStart = std::chrono::steady_clock::now();
+        const lemlib::SensorSnapshot& snapshot = snapshots[i];
+        const float dt = i == 0 ? 0.01 : (snapshot.timestamp - snapshots[i - 1].timestamp) / 1000000.0;
+        odometry.update(snapshot, dt);
+
+        particleFilterElapsed += dt;
+        if (config.runParticleFilter && particleFilterElapsed >= PARTICLE_FILTER_PERIOD) {
+            const double filterStart = threadCpuTime();
+            if (config.rangeTable != nullptr) {
+                lemlib::stepParticleFilter(pf, config.settings, particleFilterElapsed, odometry.getLocalSpeed(),
+                                           snapshot, *config.rangeTable, config.map);
+            } else {
+                const std::vector<LandmarkObs> observations = lemlib::buildObservations(
+                    snapshot, config.mounts.data(), odometry.getLocalDelta(), config.settings, gen);
+                lemlib::stepParticleFilter(pf, config.settings, particleFilterElapsed, odometry.getLocalSpeed(),
+                                           observations, config.map);
+            }
+            result.filterCpuTime += threadCpuTime() - filterStart;
+            result.filterSteps++;
+            if (pf.injected > 0) {
+                result.injectedParticles += pf.injected;
+                result.injectionSteps++;
+                result.injectionTime += pf.injection_time;
+                result.maxInjectionTime = std::max(result.maxInjectionTime, pf.injection_time);
+            }
+            particleFilterElapsed = 0;
+        }
+        result.stepTimes.push_back(
+            std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - stepStart).count());
+
+        const lemlib::Pose pose = odometry.getPose();
+        const lemlib::Pose mean =
+            config.runParticleFilter ? lemlib::getParticleMean(pf, lemlib::Pose(NAN, NAN, NAN)) : pose;
+        if (i < gt.size()) {
+            result.odomError.add(gt[i], pose.x, pose.y, pose.theta);
+            if (config.runParticleFilter && !std::isnan(mean.x))
+                result.filterError.add(gt[i], mean.x, mean.y, mean.theta);
+        }
+        if (config.recordTrace) result.trace.push_back({snapshot.timestamp, pose, mean, pf.injected});
+    }
+    result.replayTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - replayStart).count();
+    result.finalPose = odometry.getPose();
+    result.distanceTraveled = odometry.getDistanceTraveled();
+    result.imuBias = odometry.getHeadingFilter().getImuBias();
+    return result;
+}
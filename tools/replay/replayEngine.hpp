@@ -0,0 +1,163 @@
+/*
+ * replayEngine.hpp
+ * Runs odometry and the particle filter over a recorded sensor log. Shared by the replay and sweep tools.
+ *
+ * The log is a CSV file with one line per odometry update:
+ *   time_us, vertical1, vertical2, horizontal1, horizontal2, imu_deg,
+ *   front_mm, front_confidence, back_mm, back_confidence, left_mm, left_confidence, right_mm, right_confidence
+ * Tracking wheel readings are distances in inches, as reported by TrackingWheel::getDistanceTraveled(). A distance
+ * or IMU field that is empty, or a distance below 0, means the sensor didn't give a reading. Lines that don't start
+ * with a number are skipped. Like on the robot, the sensors should be reset when the log starts. lemlib::startSensorLog()
+ * records logs in this format on the robot.
+ *
+ * The ground truth file, if given, has one "x y theta" line per log line, in inches and radians, using the same
+ * convention as lemlib::getPose(true).
+ */
+
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+#include "helper_functions.h"
+#include "lemlib/chassis/odomIntegrator.hpp"
+#include "lemlib/chassis/localization.hpp"
+#include "lemlib/chassis/globalLocalization.hpp"
+#include "constants.hpp"
+
+/**
+ * @brief Running error statistics against the ground truth
+ */
+struct ErrorStats {
+        double sumPosition = 0;
+        double sumSquaredPosition = 0;
+        double maxPosition = 0;
+        double sumHeading = 0;
+        double maxHeading = 0;
+        int count = 0;
+
+        /**
+         * @brief Add the error of one estimate
+         *
+         * @param gt the ground truth
+         * @param x estimated x, in inches
+         * @param y estimated y, in inches
+         * @param theta estimated heading, in radians
+         */
+        void add(const ground_truth& gt, double x, double y, double theta);
+        /**
+         * @brief Get the root mean square position error
+         *
+         * @return double error in inches, or infinity if there were no estimates
+         */
+        double rmsPosition() const;
+        /**
+         * @brief Print the statistics on one line
+         *
+         * @param name what was estimated
+         */
+        void print(const char* name) const;
+};
+
+/**
+ * @brief A recorded sensor log, and optionally the ground truth for each line
+ */
+struct ReplayLog {
+        std::vector<lemlib::SensorSnapshot> snapshots;
+        std::vector<ground_truth> gt;
+
+        /**
+         * @brief Get how long the log covers
+         *
+         * @return double duration in seconds
+         */
+        double duration() const;
+};
+
+/**
+ * @brief Load a sensor log, and its ground truth
+ *
+ * @param logFile path to the CSV sensor log
+ * @param gtFile path to the ground truth, or an empty string if there isn't one
+ * @param log set to the loaded log
+ * @return std::string an error message, or an empty string on success
+ */
+std::string loadReplayLog(const std::string& logFile, const std::string& gtFile, ReplayLog& log);
+
+/**
+ * @brief The robot and filter to replay the log with
+ *
+ * The defaults match components.hpp: one vertical and one horizontal tracking wheel, with the right side of the
+ * drivetrain standing in for the second vertical wheel, and distance sensors on the front, left and right.
+ */
+struct ReplayConfig {
+        lemlib::OdomGeometry geometry = {{true, -0.695, false}, {true, 5.75, true}, {true, -2.625, false}, {}};
+        lemlib::OdomIntegration integration = lemlib::OdomIntegration::ARC;
+        std::array<lemlib::DistanceMount, lemlib::DISTANCE_SIDES> mounts = {
+            FRONT_DISTANCE_MOUNT, lemlib::DistanceMount {}, LEFT_DISTANCE_MOUNT, RIGHT_DISTANCE_MOUNT};
+        Map map = lemlib::getFieldMap();
+        lemlib::ParticleFilterSettings settings;
+        /** weigh the particles with a beam model using this table, instead of with landmark observations */
+        const lemlib::RangeTable* rangeTable = nullptr;
+        bool runParticleFilter = true;
+        unsigned seed = 0;
+        /** keep the pose estimates from every update in ReplayResult::trace */
+        bool recordTrace = false;
+        /** find the starting pose with localizeGlobally, instead of taking it from the ground truth */
+        bool localize = false;
+        /** the hint passed to localizeGlobally, with theta in radians */
+        lemlib::Pose localizeHint = {0, 0, 0};
+        lemlib::GlobalLocalizationSettings localizeSettings = {FEILD_SIZE};
+};
+
+/**
+ * @brief The pose estimates after one odometry update
+ */
+struct ReplayTraceEntry {
+        uint64_t timestamp;
+        lemlib::Pose odometry;
+        lemlib::Pose filter;
+        /** particles injected by the last filter step */
+        int injected;
+};
+
+/**
+ * @brief What happened during a replay
+ */
+struct ReplayResult {
+        ErrorStats odomError;
+        ErrorStats filterError;
+        /** wall time of each odometry update, including any particle filter step, in microseconds */
+        std::vector<double> stepTimes;
+        /** CPU time spent in particle filter steps, in seconds. Unaffected by other threads sharing the core */
+        double filterCpuTime = 0;
+        int filterSteps = 0;
+        /** wall time of the whole replay, in seconds */
+        double replayTime = 0;
+        /** particles replaced with random ones to recover from the robot being moved */
+        long injectedParticles = 0;
+        /** filter steps that injected particles */
+        int injectionSteps = 0;
+        /** wall time spent injecting particles, and the most in one step, in microseconds */
+        uint64_t injectionTime = 0;
+        uint64_t maxInjectionTime = 0;
+        /** the starting pose found, if ReplayConfig::localize is set */
+        lemlib::GlobalLocalization localization;
+        /** the pose estimates after every update, if ReplayConfig::recordTrace is set */
+        std::vector<ReplayTraceEntry> trace;
+        lemlib::Pose finalPose = {0, 0, 0};
+        float distanceTraveled = 0;
+        float imuBias = 0;
+};
+
+/**
+ * @brief Replay a log
+ *
+ * Odometry starts where the ground truth starts, if there is one, or where localizeGlobally finds the robot from
+ * the first few readings if ReplayConfig::localize is set. The particle filter runs at 100Hz like on the robot.
+ *
+ * @param log the log
+ * @param config the robot and filter to use
+ * @return ReplayResult
+ */
+ReplayResult runReplay(const ReplayLog& log, const ReplayConfig& config);
@@ -0,0 +1,258 @@
+/*
+ * sweep.cpp
+ * Replays recorded sensor logs with many particle filter settings, and reports which ones give the best accuracy
+ * for their cost.
+ *
+ * Every combination of the given particle counts, motion noise and landmark noise is tried (a grid), or with --random
+ * n, n settings are drawn log-uniformly between the smallest and largest of each list. Each setting is replayed once
+ * per seed, and scored by the rms position error of the filter against the ground truth and the cpu time each filter
+ * step takes. Settings that no other setting beats on both are marked as the pareto front. With --target, the
+ * cheapest setting that meets the accuracy target is printed, ready to pass to lemlib::setParticleFilterSettings.
+ *
+ * Cpu time is measured per thread, so running settings on several threads doesn't change the cost reported. It is
+ * the cost on this computer; the brain is much slower, but the ranking holds.
+ *
+ * Usage: sweep <log.csv> --gt file [--map file] [--particles n,n,...] [--motion-noise in,in,...]
+ *              [--landmark-noise in,in,...] [--random n] [--seeds n] [--seed n] [--threads n] [--target in]
+ *              [--csv file]
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include "lemlib/parallel.hpp"
+#include "../replay/replayEngine.hpp"
+
+/**
+ * @brief One setting tried, and how well it did
+ */
+struct Candidate {
+        lemlib::ParticleFilterSettings settings;
+        /** rms position error of the filter, averaged over the seeds, in inches */
+        double rmsError = INFINITY;
+        /** worst position error of the filter over every seed, in inches */
+        double maxError = INFINITY;
+        /** cpu time of one filter step, averaged over the seeds, in microseconds */
+        double stepCost = INFINITY;
+        bool pareto = false;
+};
+
+/**
+ * @brief Parse a comma separated list of numbers
+ *
+ * @param value the list
+ * @return std::vector<double>
+ */
+static std::vector<double> parseList(const std::string& value) {
+    std::vector<double> list;
+    size_t begin = 0;
+    while (begin <= value.size()) {
+        size_t end = value.find(',', begin);
+        if (end == std::string::npos) end = value.size();
+        if (end > begin) list.push_back(std::strtod(value.substr(begin, end - begin).c_str(), nullptr));
+        begin = end + 1;
+    }
+    return list;
+}
+
+/**
+ * @brief Draw a number log-uniformly between the smallest and largest of a list
+ *
+ * @param list the list
+ * @param gen random number generator
+ * @return double
+ */
+static double drawLogUniform(const std::vector<double>& list, std::mt19937& gen) {
+    const auto [low, high] = std::minmax_element(list.begin(), list.end());
+    if (*low <= 0 || *low == *high) return *low;
+    std::uniform_real_distribution<double> exponent(std::log(*low), std::log(*high));
+    return std::exp(exponent(gen));
+}
+
+/**
+ * @brief Make the settings for one candidate, keeping the defaults for everything that isn't swept
+ *
+ * @param particles number of particles
+ * @param motionNoise motion noise in x and y, in inches
+ * @param landmarkNoise landmark noise in x and y, in inches
+ * @return lemlib::ParticleFilterSettings
+ */
+static lemlib::ParticleFilterSettings makeSettings(int particles, double motionNoise, double landmarkNoise) {
+    lemlib::ParticleFilterSettings settings;
+    settings.particles = std::max(1, particles);
+    settings.motionNoise[0] = settings.motionNoise[1] = motionNoise;
+    settings.landmarkNoise[0] = settings.landmarkNoise[1] = landmarkNoise;
+    return settings;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr,
+                     "usage: %s <log.csv> --gt file [--map file] [--particles n,n,...] [--motion-noise in,in,...]\n"
+                     "       [--landmark-noise in,in,...] [--random n] [--seeds n] [--seed n] [--threads n]"
+                     " [--target in] [--csv file]\n",
+                     argv[0]);
+        return 1;
+    }
+
+    std::string gtFile, mapFile, csvFile;
+    std::vector<double> particleCounts = {100, 250, 500, 729, 1500};
+    std::vector<double> motionNoises = {0.05, 0.2, 0.5, 1};
+    std::vector<double> landmarkNoises = {0.3, 1, 3};
+    int randomCount = 0;
+    int seeds = 3;
+    unsigned seed = 0;
+    int threads = 0;
+    double target = NAN;
+    for (int i = 2; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::fprintf(stderr, "%s needs a value\n", arg.c_str());
+            return 1;
+        }
+        const std::string value = argv[++i];
+        if (arg == "--gt") gtFile = value;
+        else if (arg == "--map") mapFile = value;
+        else if (arg == "--csv") csvFile = value;
+        else if (arg == "--particles") particleCounts = parseList(value);
+        else if (arg == "--motion-noise") motionNoises = parseList(value);
+        else if (arg == "--landmark-noise") landmarkNoises = parseList(value);
+        else if (arg == "--random") randomCount = std::atoi(value.c_str());
+        else if (arg == "--seeds") seeds = std::max(1, std::atoi(value.c_str()));
+        else if (arg == "--seed") seed = std::strtoul(value.c_str(), nullptr, 10);
+        else if (arg == "--threads") threads = std::atoi(value.c_str());
+        else if (arg == "--target") target = std::strtod(value.c_str(), nullptr);
+        else {
+            std::fprintf(stderr, "unknown option %s\n", arg.c_str());
+            return 1;
+        }
+    }
+    if (gtFile.empty()) {
+        std::fprintf(stderr, "the sweep needs ground truth, given with --gt\n");
+        return 1;
+    }
+    if (particleCounts.empty() || motionNoises.empty() || landmarkNoises.empty()) {
+        std::fprintf(stderr, "every list needs at least one value\n");
+        return 1;
+    }
+
+    // load the log
+    ReplayLog log;
+    const std::string error = loadReplayLog(argv[1], gtFile, log);
+    if (!error.empty()) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    ReplayConfig config;
+    if (!mapFile.empty() && !read_map_data(mapFile, config.map)) {
+        std::fprintf(stderr, "could not open %s\n", mapFile.c_str());
+        return 1;
+    }
+
+    // pick the settings to try
+    std::vector<Candidate> candidates;
+    if (randomCount > 0) {
+        std::mt19937 gen(seed);
+        for (int i = 0; i < randomCount; i++) {
+            Candidate candidate;
+            candidate.settings = makeSettings(std::lround(drawLogUniform(particleCounts, gen)),
+                                              drawLogUniform(motionNoises, gen), drawLogUniform(landmarkNoises, gen));
+            candidates.push_back(candidate);
+        }
+    } else {
+        for (double particles : particleCounts) {
+            for (double motionNoise : motionNoises) {
+                for (double landmarkNoise : landmarkNoises) {
+                    Candidate candidate;
+                    candidate.settings = makeSettings(std::lround(particles), motionNoise, landmarkNoise);
+                    candidates.push_back(candidate);
+                }
+            }
+        }
+    }
+
+    // replay each setting on its own thread. The filter itself stays on the serial backend, since the pool only runs
+    // one loop at a time
+    lemlib::ThreadPoolBackend pool(threads);
+    std::printf("trying %zu settings with %d seeds on %d threads\n", candidates.size(), seeds,
+                pool.getConcurrency());
+    pool.run(candidates.size(), [&](std::size_t index) {
+        Candidate& candidate = candidates[index];
+        ReplayConfig candidateConfig = config;
+        candidateConfig.settings = candidate.settings;
+        double sumRms = 0, maxError = 0, cpuTime = 0;
+        int steps = 0;
+        for (int i = 0; i < seeds; i++) {
+            candidateConfig.seed = seed + i;
+            const ReplayResult result = runReplay(log, candidateConfig);
+            // a filter that lost every particle never gets close, so it can't be scored
+            if (result.filterError.count == 0) return;
+            sumRms += result.filterError.rmsPosition();
+            maxError = std::max(maxError, result.filterError.maxPosition);
+            cpuTime += result.filterCpuTime;
+            steps += result.filterSteps;
+        }
+        candidate.rmsError = sumRms / seeds;
+        candidate.maxError = maxError;
+        candidate.stepCost = steps > 0 ? cpuTime / steps * 1e6 : INFINITY;
+    });
+
+    // mark the settings that no other setting is both cheaper and more accurate than
+    for (Candidate& candidate : candidates) {
+        if (std::isinf(candidate.rmsError)) continue;
+        candidate.pareto = std::none_of(candidates.begin(), candidates.end(), [&](const Candidate& other) {
+            return other.rmsError <= candidate.rmsError && other.stepCost <= candidate.stepCost &&
+                   (other.rmsError < candidate.rmsError || other.stepCost < candidate.stepCost);
+        });
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [](const Candidate& a, const Candidate& b) { return a.stepCost < b.stepCost; });
+
+    // report
+    std::printf("%9s %12s %14s %10s %10s %12s %s\n", "particles", "motion (in)", "landmark (in)", "rms (in)",
+                "max (in)", "cost (us)", "pareto");
+    for (const Candidate& candidate : candidates) {
+        std::printf("%9d %12.3f %14.3f %10.3f %10.3f %12.2f %s\n", candidate.settings.particles,
+                    candidate.settings.motionNoise[0], candidate.settings.landmarkNoise[0], candidate.rmsError,
+                    candidate.maxError, candidate.stepCost, candidate.pareto ? "*" : "");
+    }
+    if (!csvFile.empty()) {
+        FILE* csv = std::fopen(csvFile.c_str(), "w");
+        if (!csv) {
+            std::fprintf(stderr, "could not open %s\n", csvFile.c_str());
+            return 1;
+        }
+        std::fprintf(csv, "particles,motion_noise,landmark_noise,rms_error,max_error,step_cost_us,pareto\n");
+        for (const Candidate& candidate : candidates) {
+            std::fprintf(csv, "%d,%g,%g,%g,%g,%g,%d\n", candidate.settings.particles,
+                         candidate.settings.motionNoise[0], candidate.settings.landmarkNoise[0], candidate.rmsError,
+                         candidate.maxError, candidate.stepCost, candidate.pareto);
+        }
+        std::fclose(csv);
+    }
+
+    if (!std::isnan(target)) {
+        // candidates are sorted by cost, so the first one to meet the target is the cheapest
+        auto best = std::find_if(candidates.begin(), candidates.end(),
+                                 [&](const Candidate& candidate) { return candidate.rmsError <= target; });
+        if (best == candidates.end()) {
+            std::printf("no setting met the target of %.3f in\n", target);
+            return 2;
+        }
+        const lemlib::ParticleFilterSettings& settings = best->settings;
+        std::printf("cheapest setting within %.3f in: %.3f in rms for %.2f us per step\n", target, best->rmsError,
+                    best->stepCost);
+        std::printf("lemlib::ParticleFilterSettings settings;\n"
+                    "settings.particles = %d;\n"
+                    "settings.motionNoise = {%g, %g, %g};\n"
+                    "settings.landmarkNoise = {%g, %g};\n"
+                    "lemlib::setParticleFilterSettings(settings);\n",
+                    settings.particles, settings.motionNoise[0], settings.motionNoise[1], settings.motionNoise[2],
+                    settings.landmarkNoise[0], settings.landmarkNoise[1]);
+    }
+    return 0;
+}